@@ -379,6 +379,9 @@ void STDMETHODCALLTYPE CFW1FontWrapper::DrawGeometry(
 		UINT temp = m_pGlyphVertexDrawer->DrawVertices(pContext, m_pGlyphAtlas, &vertexData, Flags, 0xffffffff);
 		temp;
 		
+		// Keep the drawn glyphs from being evicted
+		m_pGlyphAtlas->MarkGlyphsUsed(&vertexData);
+		
 		// Restore state
 		if(restoreState)
 			stateSaver.restoreSavedState();
@@ -24,7 +24,12 @@ CFW1GlyphAtlas::CFW1GlyphAtlas() :
 	m_sheetCount(0),
 	m_maxSheetCount(0),
 	m_currentSheetIndex(0),
-	m_flushedSheetIndex(0)
+	m_flushedSheetIndex(0),
+	
+	m_frame(0),
+	m_lastCompactFrame(0),
+	m_lastInsertFailedFrame(0xffffffff),
+	m_insertFailed(false)
 {
 	InitializeCriticalSection(&m_glyphSheetsCriticalSection);
 }
@@ -78,13 +83,8 @@ HRESULT CFW1GlyphAtlas::initGlyphAtlas(
 	
 	// Default glyph
 	BYTE glyph0Pixels[256];
-	FillMemory(glyph0Pixels, 256, 0xff);
-	
 	FW1_GLYPHMETRICS glyph0Metrics;
-	glyph0Metrics.OffsetX = 0.0f;
-	glyph0Metrics.OffsetY = 0.0f;
-	glyph0Metrics.Width = 16;
-	glyph0Metrics.Height = 16;
+	getDefaultGlyph(&glyph0Metrics, glyph0Pixels);
 	
 	UINT glyph0 = InsertGlyph(&glyph0Metrics, glyph0Pixels, 16, 1);
 	if(glyph0 == 0xffffffff)
@@ -119,4 +119,42 @@ HRESULT CFW1GlyphAtlas::createGlyphSheet(IFW1GlyphSheet **ppGlyphSheet) {
 }
 
 
+// Get the default glyph, a 16x16 white square that is always atlas ID 0
+void CFW1GlyphAtlas::getDefaultGlyph(FW1_GLYPHMETRICS *pGlyphMetrics, BYTE *pGlyphPixels) {
+	FillMemory(pGlyphPixels, 256, 0xff);
+	
+	pGlyphMetrics->OffsetX = 0.0f;
+	pGlyphMetrics->OffsetY = 0.0f;
+	pGlyphMetrics->Width = 16;
+	pGlyphMetrics->Height = 16;
+}
+
+
+// Remove all glyphs from a sheet and open it for new glyphs, called with the sheets critical section held
+bool CFW1GlyphAtlas::resetSheet(UINT sheetIndex) {
+	IFW1GlyphSheet *pGlyphSheet = m_glyphSheets[sheetIndex];
+	
+	HRESULT hResult = pGlyphSheet->ResetSheet();
+	if(FAILED(hResult))
+		return false;
+	
+	// The first sheet has to keep the default glyph at index 0
+	if(sheetIndex == 0) {
+		BYTE glyph0Pixels[256];
+		FW1_GLYPHMETRICS glyph0Metrics;
+		getDefaultGlyph(&glyph0Metrics, glyph0Pixels);
+		
+		pGlyphSheet->InsertGlyph(&glyph0Metrics, glyph0Pixels, 16, 1);
+	}
+	
+	// Sheets before the open range are only filled and flushed again through the recycled list
+	if(sheetIndex < m_currentSheetIndex) {
+		if(std::find(m_recycledSheets.begin(), m_recycledSheets.end(), sheetIndex) == m_recycledSheets.end())
+			m_recycledSheets.push_back(sheetIndex);
+	}
+	
+	return true;
+}
+
+
 }// namespace FW1FontWrapper
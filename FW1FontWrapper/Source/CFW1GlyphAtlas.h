@@ -34,6 +34,9 @@ class CFW1GlyphAtlas : public CFW1Object<IFW1GlyphAtlas> {
 		);
 		virtual UINT STDMETHODCALLTYPE InsertSheet(IFW1GlyphSheet *pGlyphSheet);
 		virtual void STDMETHODCALLTYPE Flush(ID3D11DeviceContext *pContext);
+		
+		virtual void STDMETHODCALLTYPE MarkGlyphsUsed(const FW1_VERTEXDATA *pVertexData);
+		virtual UINT STDMETHODCALLTYPE EvictGlyphs(UINT MaxIdleFrames, BOOL *pEvictedSheets, UINT SheetCount);
 	
 	// Public functions
 	public:
@@ -56,6 +59,8 @@ class CFW1GlyphAtlas : public CFW1Object<IFW1GlyphAtlas> {
 		virtual ~CFW1GlyphAtlas();
 		
 		HRESULT createGlyphSheet(IFW1GlyphSheet **ppGlyphSheet);
+		void getDefaultGlyph(FW1_GLYPHMETRICS *pGlyphMetrics, BYTE *pGlyphPixels);
+		bool resetSheet(UINT sheetIndex);
 	
 	// Internal data
 	private:
@@ -72,6 +77,12 @@ class CFW1GlyphAtlas : public CFW1Object<IFW1GlyphAtlas> {
 		UINT						m_maxSheetCount;
 		UINT						m_currentSheetIndex;
 		UINT						m_flushedSheetIndex;
+		std::vector<UINT>			m_recycledSheets;
+		
+		UINT						m_frame;
+		UINT						m_lastCompactFrame;
+		UINT						m_lastInsertFailedFrame;
+		bool						m_insertFailed;
 		
 		CRITICAL_SECTION			m_glyphSheetsCriticalSection;
 };
@@ -104,10 +104,21 @@ UINT STDMETHODCALLTYPE CFW1GlyphAtlas::InsertGlyph(
 	EnterCriticalSection(&m_glyphSheetsCriticalSection);
 	UINT start = m_currentSheetIndex;
 	UINT end = m_sheetCount;
+	std::vector<UINT> recycledSheets(m_recycledSheets);
 	LeaveCriticalSection(&m_glyphSheetsCriticalSection);
 	
-	// Attempt to insert glyph
-	for(UINT i=start; i < end; ++i) {
+	// Attempt to insert glyph, filling sheets freed by eviction first
+	for(size_t i=0; i < recycledSheets.size(); ++i) {
+		IFW1GlyphSheet *pGlyphSheet = m_glyphSheets[recycledSheets[i]];
+		
+		glyphIndex = pGlyphSheet->InsertGlyph(pGlyphMetrics, pGlyphData, RowPitch, PixelStride);
+		if(glyphIndex != 0xffffffff) {
+			sheetIndex = recycledSheets[i];
+			break;
+		}
+	}
+	
+	for(UINT i=start; i < end && glyphIndex == 0xffffffff; ++i) {
 		IFW1GlyphSheet *pGlyphSheet = m_glyphSheets[i];
 		
 		glyphIndex = pGlyphSheet->InsertGlyph(pGlyphMetrics, pGlyphData, RowPitch, PixelStride);
@@ -133,8 +144,21 @@ UINT STDMETHODCALLTYPE CFW1GlyphAtlas::InsertGlyph(
 		}
 	}
 	
-	if(glyphIndex == 0xffffffff)
+	if(glyphIndex == 0xffffffff) {
+		// Out of sheets, let the next EvictGlyphs free some
+		EnterCriticalSection(&m_glyphSheetsCriticalSection);
+		if(m_sheetCount >= m_maxSheetCount)
+			m_insertFailed = true;
+		LeaveCriticalSection(&m_glyphSheetsCriticalSection);
+		
 		return 0xffffffff;
+	}
+	
+	// A new glyph counts as drawn this frame, so it is not evicted before it is first drawn
+	FW1_GLYPHVERTEX glyphVertex;
+	ZeroMemory(&glyphVertex, sizeof(glyphVertex));
+	glyphVertex.GlyphIndex = glyphIndex;
+	m_glyphSheets[sheetIndex]->MarkGlyphsUsed(&glyphVertex, 1, m_frame);
 	
 	return (sheetIndex << 16) | glyphIndex;
 }
@@ -187,10 +211,136 @@ void STDMETHODCALLTYPE CFW1GlyphAtlas::Flush(ID3D11DeviceContext *pContext) {
 	
 	m_flushedSheetIndex = m_currentSheetIndex;
 	
+	// Restrict the number of open recycled sheets, the oldest ones are closed and flushed one last time
+	std::vector<UINT> recycledSheets(m_recycledSheets);
+	
+	UINT numActiveSheets = 4;
+	UINT closeCount = 0;
+	if(m_recycledSheets.size() > numActiveSheets) {
+		closeCount = static_cast<UINT>(m_recycledSheets.size()) - numActiveSheets;
+		m_recycledSheets.erase(m_recycledSheets.begin(), m_recycledSheets.begin() + closeCount);
+	}
+	
 	LeaveCriticalSection(&m_glyphSheetsCriticalSection);
 	
+	for(UINT i=0; i < closeCount; ++i)
+		m_glyphSheets[recycledSheets[i]]->CloseSheet();
+	
 	for(UINT i=first; i < end; ++i)
 		m_glyphSheets[i]->Flush(pContext);
+	
+	for(size_t i=0; i < recycledSheets.size(); ++i) {
+		if(recycledSheets[i] < first || recycledSheets[i] >= end)
+			m_glyphSheets[recycledSheets[i]]->Flush(pContext);
+	}
+}
+
+
+// Stamp drawn glyphs with the current frame
+void STDMETHODCALLTYPE CFW1GlyphAtlas::MarkGlyphsUsed(const FW1_VERTEXDATA *pVertexData) {
+	if(pVertexData == NULL)
+		return;
+	
+	UINT sheetCount = std::min(pVertexData->SheetCount, m_sheetCount);
+	const FW1_GLYPHVERTEX *pVertices = pVertexData->pVertices;
+	
+	for(UINT i=0; i < sheetCount; ++i) {
+		UINT vertexCount = pVertexData->pVertexCounts[i];
+		if(vertexCount > 0)
+			m_glyphSheets[i]->MarkGlyphsUsed(pVertices, vertexCount, m_frame);
+		
+		pVertices += vertexCount;
+	}
+}
+
+
+// Reset sheets with glyphs that have not been drawn recently
+UINT STDMETHODCALLTYPE CFW1GlyphAtlas::EvictGlyphs(UINT MaxIdleFrames, BOOL *pEvictedSheets, UINT SheetCount) {
+	if(pEvictedSheets == NULL)
+		return 0;
+	
+	// Frames between passes that repack sparse sheets
+	UINT compactInterval = 256;
+	
+	for(UINT i=0; i < SheetCount; ++i)
+		pEvictedSheets[i] = FALSE;
+	
+	EnterCriticalSection(&m_glyphSheetsCriticalSection);
+	
+	UINT sheetCount = std::min(m_sheetCount, SheetCount);
+	UINT sinceFrame = (m_frame > MaxIdleFrames) ? m_frame - MaxIdleFrames : 0;
+	
+	bool outOfSheets = m_insertFailed;
+	m_insertFailed = false;
+	if(outOfSheets)
+		m_lastInsertFailedFrame = m_frame;
+	
+	// Only repack when sheets are running short, resetting a sheet invalidates every glyph cached from it
+	bool nearlyOutOfSheets = m_sheetCount * 4 >= m_maxSheetCount * 3;
+	bool insertFailedRecently = m_lastInsertFailedFrame != 0xffffffff && m_frame - m_lastInsertFailedFrame < compactInterval;
+	
+	bool compact = (m_frame - m_lastCompactFrame >= compactInterval) && (nearlyOutOfSheets || insertFailedRecently);
+	if(compact)
+		m_lastCompactFrame = m_frame;
+	
+	UINT evictedCount = 0;
+	
+	UINT sparsestSheet = 0xffffffff;
+	UINT sparsestUsedCount = 0;
+	UINT sparsestGlyphCount = 0;
+	
+	if(outOfSheets || compact) {
+		for(UINT i=0; i < sheetCount; ++i) {
+			IFW1GlyphSheet *pGlyphSheet = m_glyphSheets[i];
+			
+			FW1_GLYPHSHEETDESC desc;
+			pGlyphSheet->GetDesc(&desc);
+			
+			// The first sheet always holds the default glyph
+			UINT minGlyphCount = (i == 0) ? 1 : 0;
+			if(desc.GlyphCount <= minGlyphCount)
+				continue;
+			
+			UINT usedCount = pGlyphSheet->GetUsedGlyphCount(sinceFrame);
+			bool closed = i < m_currentSheetIndex &&
+				std::find(m_recycledSheets.begin(), m_recycledSheets.end(), i) == m_recycledSheets.end();
+			
+			bool evict = false;
+			
+			// Nothing in the sheet has been drawn recently
+			if(outOfSheets && usedCount == 0)
+				evict = true;
+			
+			// Mostly unused closed sheet, the glyphs still in use are packed into open sheets when next requested
+			else if(compact && closed && usedCount * 4 < desc.GlyphCount)
+				evict = true;
+			
+			// Remember the sparsest sheet in case no sheet is completely unused
+			else if(outOfSheets && usedCount * 2 < desc.GlyphCount) {
+				if(sparsestSheet == 0xffffffff || usedCount * sparsestGlyphCount < sparsestUsedCount * desc.GlyphCount) {
+					sparsestSheet = i;
+					sparsestUsedCount = usedCount;
+					sparsestGlyphCount = desc.GlyphCount;
+				}
+			}
+			
+			if(evict && resetSheet(i)) {
+				pEvictedSheets[i] = TRUE;
+				++evictedCount;
+			}
+		}
+		
+		if(evictedCount == 0 && sparsestSheet != 0xffffffff && resetSheet(sparsestSheet)) {
+			pEvictedSheets[sparsestSheet] = TRUE;
+			++evictedCount;
+		}
+	}
+	
+	++m_frame;
+	
+	LeaveCriticalSection(&m_glyphSheetsCriticalSection);
+	
+	return evictedCount;
 }
 
 
@@ -0,0 +1,55 @@
+// CFW1GlyphPages.cpp
+
+#include "FW1Precompiled.h"
+
+#include "CFW1GlyphPages.h"
+
+
+namespace FW1FontWrapper {
+
+
+// Construct with no pages, glyph 0 is always looked up so there is at least one page slot
+CFW1GlyphPages::CFW1GlyphPages(UINT glyphCount) :
+	m_pageCount(std::max((glyphCount + PageSize - 1) >> PageBits, 1U)),
+	m_glyphCount(glyphCount)
+{
+	m_pages = new UINT* volatile [m_pageCount];
+	for(UINT i=0; i < m_pageCount; ++i)
+		m_pages[i] = 0;
+}
+
+
+// Destruct
+CFW1GlyphPages::~CFW1GlyphPages() {
+	for(UINT i=0; i < m_pageCount; ++i)
+		delete[] m_pages[i];
+	delete[] m_pages;
+}
+
+
+// Set the atlas id of a glyph
+void CFW1GlyphPages::setAtlasId(UINT glyphIndex, UINT glyphAtlasId) {
+	UINT pageIndex = glyphIndex >> PageBits;
+	
+	UINT *page = m_pages[pageIndex];
+	if(page == 0) {
+		if(glyphAtlasId == 0xffffffff)
+			return;
+		
+		page = new UINT[PageSize];
+		for(UINT i=0; i < PageSize; ++i)
+			page[i] = 0xffffffff;
+		page[glyphIndex & (PageSize - 1)] = glyphAtlasId;
+		
+		// Readers look up pages without locking, so the page must be filled before it is published
+		_WriteBarrier();
+		MemoryBarrier();
+		
+		m_pages[pageIndex] = page;
+	}
+	else
+		page[glyphIndex & (PageSize - 1)] = glyphAtlasId;
+}
+
+
+}// namespace FW1FontWrapper
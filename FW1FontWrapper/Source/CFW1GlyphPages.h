@@ -0,0 +1,60 @@
+// CFW1GlyphPages.h
+
+#ifndef IncludeGuard__FW1_CFW1GlyphPages
+#define IncludeGuard__FW1_CFW1GlyphPages
+
+
+namespace FW1FontWrapper {
+
+
+// Atlas ids of the glyphs of one font, stored in pages of consecutive glyphs allocated the first time a glyph in the page is set
+// Lookups do not lock, setting ids must be serialized by the caller
+// Used by CFW1GlyphProvider, it has no device dependencies so it can be used on its own
+class CFW1GlyphPages {
+	// Public functions
+	public:
+		enum {
+			PageBits = 8,
+			PageSize = 1 << PageBits
+		};
+		
+		CFW1GlyphPages(UINT glyphCount);
+		~CFW1GlyphPages();
+		
+		UINT getAtlasId(UINT glyphIndex) const {
+			const UINT *page = m_pages[glyphIndex >> PageBits];
+			if(page == 0)
+				return 0xffffffff;
+			_ReadBarrier();
+			return page[glyphIndex & (PageSize - 1)];
+		}
+		void setAtlasId(UINT glyphIndex, UINT glyphAtlasId);
+		
+		UINT getGlyphCount() const {
+			return m_glyphCount;
+		}
+		UINT getPageCount() const {
+			return m_pageCount;
+		}
+		UINT* getPage(UINT pageIndex) const {
+			return m_pages[pageIndex];
+		}
+	
+	// Internal types
+	private:
+		CFW1GlyphPages();
+		CFW1GlyphPages(const CFW1GlyphPages&);
+		CFW1GlyphPages& operator=(const CFW1GlyphPages&);
+	
+	// Internal data
+	private:
+		UINT * volatile			*m_pages;
+		UINT					m_pageCount;
+		UINT					m_glyphCount;
+};
+
+
+}// namespace FW1FontWrapper
+
+
+#endif// IncludeGuard__FW1_CFW1GlyphPages
@@ -18,12 +18,18 @@ CFW1GlyphProvider::CFW1GlyphProvider() :
 	m_maxGlyphWidth(0),
 	m_maxGlyphHeight(0),
 	
-	m_pFontCollection(NULL)
+	m_pFontCollection(NULL),
+	
+	m_activeWorkerCount(0),
+	m_maxWorkerCount(1),
+	m_pendingGlyphCount(0),
+	m_placeholderCount(0)
 {
 	InitializeCriticalSection(&m_renderTargetsCriticalSection);
 	InitializeCriticalSection(&m_glyphMapsCriticalSection);
 	InitializeCriticalSection(&m_fontsCriticalSection);
 	InitializeCriticalSection(&m_insertGlyphCriticalSection);
+	InitializeCriticalSection(&m_glyphJobsCriticalSection);
 }
 
 
@@ -39,20 +45,21 @@ CFW1GlyphProvider::~CFW1GlyphProvider() {
 	}
 	
 	SAFE_RELEASE(m_pFontCollection);
-	for(size_t i=0; i < m_fonts.size(); ++i)
-		SAFE_RELEASE(m_fonts[i].pFontFace);
+	for(size_t i=0; i < m_fontFaces.size(); ++i)
+		m_fontFaces[i]->Release();
 	
-	for(FontMap::iterator it = m_fontMap.begin(); it != m_fontMap.end(); ++it) {
-		GlyphMap *glyphMap = (*it).second;
-		
-		delete[] glyphMap->glyphs;
-		delete glyphMap;
-	}
+	// Workers hold a reference, so only glyphs that were never inserted can be left
+	for(size_t i=0; i < m_completedGlyphs.size(); ++i)
+		delete m_completedGlyphs[i];
+	
+	for(size_t i=0; i < m_glyphMaps.size(); ++i)
+		deleteGlyphMap(m_glyphMaps[i]);
 	
 	DeleteCriticalSection(&m_renderTargetsCriticalSection);
 	DeleteCriticalSection(&m_glyphMapsCriticalSection);
 	DeleteCriticalSection(&m_fontsCriticalSection);
 	DeleteCriticalSection(&m_insertGlyphCriticalSection);
+	DeleteCriticalSection(&m_glyphJobsCriticalSection);
 }
 
 
@@ -88,45 +95,38 @@ HRESULT CFW1GlyphProvider::initGlyphProvider(
 	pFontCollection->AddRef();
 	m_pFontCollection = pFontCollection;
 	
+	// Leave one processor for the thread laying out text
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	m_maxWorkerCount = std::min(std::max(systemInfo.dwNumberOfProcessors, 2UL) - 1, 8UL);
+	
 	return S_OK;
 }
 
 
 // Get font index from DWrite font-face
 UINT CFW1GlyphProvider::getFontIndexFromFontFace(IDWriteFontFace *pFontFace) {
-	UINT fontIndex = 0xffffffff;
+	UINT hash = hashFontFace(pFontFace);
 	
-	EnterCriticalSection(&m_fontsCriticalSection);
+	// Font-faces seen before are found without locking
+	UINT fontIndex = m_fontFaceMap.find(pFontFace, hash, 0xffffffff);
+	if(fontIndex != 0xffffffff)
+		return fontIndex;
 	
-	// Search for a matching fontface by pointer
-	for(size_t i=0; i < m_fonts.size(); ++i) {
-		const FontInfo &fontInfo = m_fonts[i];
-		
-		if(pFontFace == fontInfo.pFontFace) {
-			fontIndex = static_cast<UINT>(i);
-			break;
-		}
-	}
+	// Get font-face name, font-faces without one all share the first font
+	std::wstring uniqueName = getUniqueNameFromFontFace(pFontFace);
 	
-	LeaveCriticalSection(&m_fontsCriticalSection);
+	EnterCriticalSection(&m_fontsCriticalSection);
 	
-	// Get font-face name
+	// Another thread may have added the font-face meanwhile
+	fontIndex = m_fontFaceMap.find(pFontFace, hash, 0xffffffff);
 	if(fontIndex == 0xffffffff) {
-		std::wstring uniqueName = getUniqueNameFromFontFace(pFontFace);
-		if(uniqueName.size() > 0) {
-			IDWriteFontFace *pOldFontFace = NULL;
-			
-			pFontFace->AddRef();
-			
-			EnterCriticalSection(&m_fontsCriticalSection);
-			
-			// Search for a matching fontface by name
+		if(uniqueName.size() == 0)
+			fontIndex = 0;
+		else {
+			// Search for a matching font by name
 			for(size_t i=0; i < m_fonts.size(); ++i) {
-				FontInfo &fontInfo = m_fonts[i];
-				
-				if(fontInfo.uniqueName == uniqueName) {
-					pOldFontFace = fontInfo.pFontFace;
-					fontInfo.pFontFace = pFontFace;
+				if(m_fonts[i].uniqueName == uniqueName) {
 					fontIndex = static_cast<UINT>(i);
 					break;
 				}
@@ -136,21 +136,25 @@ UINT CFW1GlyphProvider::getFontIndexFromFontFace(IDWriteFontFace *pFontFace) {
 			if(fontIndex == 0xffffffff) {
 				FontInfo fontInfo;
 				
-				fontInfo.pFontFace = pFontFace;
 				fontInfo.uniqueName = uniqueName;
 				
 				fontIndex = static_cast<UINT>(m_fonts.size());
 				m_fonts.push_back(fontInfo);
 			}
+		}
+		
+		// Map every font-face, nameless ones included, so the next lookup does not lock or build its name again
+		// The reference keeps the pointer from being reused by another font-face while it is in the map
+		if(m_fontFaces.size() < MaxMappedFontFaces) {
+			pFontFace->AddRef();
+			m_fontFaces.push_back(pFontFace);
 			
-			LeaveCriticalSection(&m_fontsCriticalSection);
-			
-			SAFE_RELEASE(pOldFontFace);
+			m_fontFaceMap.insert(pFontFace, hash, fontIndex);
 		}
-		else
-			fontIndex = 0;
 	}
 	
+	LeaveCriticalSection(&m_fontsCriticalSection);
+	
 	return fontIndex;
 }
 
@@ -237,6 +241,161 @@ UINT CFW1GlyphProvider::insertNewGlyph(GlyphMap *glyphMap, UINT16 glyphIndex, ID
 	UINT glyphAtlasId = 0xffffffff;
 	
 	// Get a render target
+	IFW1DWriteRenderTarget *pRenderTarget = getRenderTarget();
+	
+	if(pRenderTarget != NULL) {
+		// Draw the glyph image
+		FW1_GLYPHIMAGEDATA glyphData;
+		HRESULT hResult = drawGlyph(pRenderTarget, glyphMap, glyphIndex, pFontFace, &glyphData);
+		if(FAILED(hResult)) {
+		}
+		else {
+			// Insert into the atlas and the glyph-map
+			EnterCriticalSection(&m_insertGlyphCriticalSection);
+			
+			glyphAtlasId = glyphMap->glyphPages.getAtlasId(glyphIndex);
+			if(glyphAtlasId == 0xffffffff) {
+				glyphAtlasId = m_pGlyphAtlas->InsertGlyph(
+					&glyphData.Metrics,
+					glyphData.pGlyphPixels,
+					glyphData.RowPitch,
+					glyphData.PixelStride
+				);
+				if(glyphAtlasId != 0xffffffff)
+					glyphMap->glyphPages.setAtlasId(glyphIndex, glyphAtlasId);
+			}
+			
+			LeaveCriticalSection(&m_insertGlyphCriticalSection);
+		}
+		
+		// Keep the render target for future use
+		releaseRenderTarget(pRenderTarget);
+	}
+	
+	return glyphAtlasId;
+}
+
+
+// Queue a new glyph to be rendered on a worker thread
+UINT CFW1GlyphProvider::queueNewGlyph(GlyphMap *glyphMap, UINT16 glyphIndex, IDWriteFontFace *pFontFace) {
+	// Mark the glyph as pending so it is only queued once
+	EnterCriticalSection(&m_insertGlyphCriticalSection);
+	
+	UINT glyphAtlasId = glyphMap->glyphPages.getAtlasId(glyphIndex);
+	if(glyphAtlasId == 0xffffffff)
+		glyphMap->glyphPages.setAtlasId(glyphIndex, PendingAtlasId);
+	
+	LeaveCriticalSection(&m_insertGlyphCriticalSection);
+	
+	if(glyphAtlasId != 0xffffffff)
+		return glyphAtlasId;
+	
+	GlyphJob glyphJob;
+	glyphJob.glyphMap = glyphMap;
+	glyphJob.glyphIndex = glyphIndex;
+	glyphJob.pFontFace = pFontFace;
+	pFontFace->AddRef();
+	
+	// Start another worker if all running workers are busy
+	bool startWorker = false;
+	
+	EnterCriticalSection(&m_glyphJobsCriticalSection);
+	
+	m_glyphJobs.push_back(glyphJob);
+	++m_pendingGlyphCount;
+	
+	if(m_activeWorkerCount < m_maxWorkerCount) {
+		++m_activeWorkerCount;
+		startWorker = true;
+	}
+	
+	LeaveCriticalSection(&m_glyphJobsCriticalSection);
+	
+	if(startWorker) {
+		AddRef();
+		if(!QueueUserWorkItem(rasterizeGlyphsProc, this, WT_EXECUTEDEFAULT)) {
+			// No thread pool, rasterize on this thread instead
+			rasterizeQueuedGlyphs();
+			Release();
+		}
+	}
+	
+	return PendingAtlasId;
+}
+
+
+// Rasterize queued glyphs until the queue is empty
+void CFW1GlyphProvider::rasterizeQueuedGlyphs() {
+	IFW1DWriteRenderTarget *pRenderTarget = getRenderTarget();
+	
+	for(;;) {
+		EnterCriticalSection(&m_glyphJobsCriticalSection);
+		
+		if(m_glyphJobs.empty()) {
+			--m_activeWorkerCount;
+			LeaveCriticalSection(&m_glyphJobsCriticalSection);
+			break;
+		}
+		
+		GlyphJob glyphJob = m_glyphJobs.back();
+		m_glyphJobs.pop_back();
+		
+		LeaveCriticalSection(&m_glyphJobsCriticalSection);
+		
+		RasterizedGlyph *rasterizedGlyph = new RasterizedGlyph;
+		rasterizedGlyph->glyphMap = glyphJob.glyphMap;
+		rasterizedGlyph->glyphIndex = glyphJob.glyphIndex;
+		rasterizedGlyph->succeeded = false;
+		
+		if(pRenderTarget != NULL) {
+			FW1_GLYPHIMAGEDATA glyphData;
+			HRESULT hResult = drawGlyph(pRenderTarget, glyphJob.glyphMap, glyphJob.glyphIndex, glyphJob.pFontFace, &glyphData);
+			if(FAILED(hResult)) {
+			}
+			else {
+				// The image is only valid until the next draw, so keep a tightly packed copy
+				const UINT width = glyphData.Metrics.Width;
+				const UINT height = glyphData.Metrics.Height;
+				
+				rasterizedGlyph->metrics = glyphData.Metrics;
+				rasterizedGlyph->pixels.resize(width * height);
+				
+				for(UINT i=0; i < height; ++i) {
+					const UINT8 *src = static_cast<const UINT8*>(glyphData.pGlyphPixels) + i*glyphData.RowPitch;
+					UINT8 *dst = &rasterizedGlyph->pixels[0] + i*width;
+					for(UINT j=0; j < width; ++j)
+						dst[j] = src[j*glyphData.PixelStride];
+				}
+				
+				rasterizedGlyph->succeeded = true;
+			}
+		}
+		
+		glyphJob.pFontFace->Release();
+		
+		EnterCriticalSection(&m_glyphJobsCriticalSection);
+		m_completedGlyphs.push_back(rasterizedGlyph);
+		LeaveCriticalSection(&m_glyphJobsCriticalSection);
+	}
+	
+	if(pRenderTarget != NULL)
+		releaseRenderTarget(pRenderTarget);
+}
+
+
+// Thread pool entry point for glyph workers
+DWORD WINAPI CFW1GlyphProvider::rasterizeGlyphsProc(LPVOID pParameter) {
+	CFW1GlyphProvider *pGlyphProvider = static_cast<CFW1GlyphProvider*>(pParameter);
+	
+	pGlyphProvider->rasterizeQueuedGlyphs();
+	pGlyphProvider->Release();
+	
+	return 0;
+}
+
+
+// Get a render target from the pool, or create a new one
+IFW1DWriteRenderTarget* CFW1GlyphProvider::getRenderTarget() {
 	IFW1DWriteRenderTarget *pRenderTarget = NULL;
 	
 	EnterCriticalSection(&m_renderTargetsCriticalSection);
@@ -263,53 +422,68 @@ UINT CFW1GlyphProvider::insertNewGlyph(GlyphMap *glyphMap, UINT16 glyphIndex, ID
 		}
 	}
 	
-	if(pRenderTarget != NULL) {
-		// Draw the glyph image
-		DWRITE_RENDERING_MODE renderingMode = DWRITE_RENDERING_MODE_DEFAULT;
-		DWRITE_MEASURING_MODE measuringMode = DWRITE_MEASURING_MODE_NATURAL;
-		if((glyphMap->fontFlags & FW1_ALIASED) != 0) {
-			renderingMode = DWRITE_RENDERING_MODE_ALIASED;
-			measuringMode = DWRITE_MEASURING_MODE_GDI_CLASSIC;
-		}
-		
-		FW1_GLYPHIMAGEDATA glyphData;
-		HRESULT hResult = pRenderTarget->DrawGlyphTemp(
-			pFontFace,
-			glyphIndex,
-			glyphMap->fontSize,
-			renderingMode,
-			measuringMode,
-			&glyphData
-		);
-		if(FAILED(hResult)) {
-		}
-		else {
-			// Insert into the atlas and the glyph-map
-			EnterCriticalSection(&m_insertGlyphCriticalSection);
-			
-			glyphAtlasId = glyphMap->glyphs[glyphIndex];
-			if(glyphAtlasId == 0xffffffff) {
-				glyphAtlasId = m_pGlyphAtlas->InsertGlyph(
-					&glyphData.Metrics,
-					glyphData.pGlyphPixels,
-					glyphData.RowPitch,
-					glyphData.PixelStride
-				);
-				if(glyphAtlasId != 0xffffffff)
-					glyphMap->glyphs[glyphIndex] = glyphAtlasId;
-			}
-			
-			LeaveCriticalSection(&m_insertGlyphCriticalSection);
-		}
-		
-		// Keep the render target for future use
-		EnterCriticalSection(&m_renderTargetsCriticalSection);
-		m_glyphRenderTargets.push(pRenderTarget);
-		LeaveCriticalSection(&m_renderTargetsCriticalSection);
+	return pRenderTarget;
+}
+
+
+// Return a render target to the pool
+void CFW1GlyphProvider::releaseRenderTarget(IFW1DWriteRenderTarget *pRenderTarget) {
+	EnterCriticalSection(&m_renderTargetsCriticalSection);
+	m_glyphRenderTargets.push(pRenderTarget);
+	LeaveCriticalSection(&m_renderTargetsCriticalSection);
+}
+
+
+// Draw a glyph image with the rendering mode of its glyph-map
+HRESULT CFW1GlyphProvider::drawGlyph(
+	IFW1DWriteRenderTarget *pRenderTarget,
+	const GlyphMap *glyphMap,
+	UINT16 glyphIndex,
+	IDWriteFontFace *pFontFace,
+	FW1_GLYPHIMAGEDATA *pGlyphData
+) {
+	DWRITE_RENDERING_MODE renderingMode = DWRITE_RENDERING_MODE_DEFAULT;
+	DWRITE_MEASURING_MODE measuringMode = DWRITE_MEASURING_MODE_NATURAL;
+	if((glyphMap->fontFlags & FW1_ALIASED) != 0) {
+		renderingMode = DWRITE_RENDERING_MODE_ALIASED;
+		measuringMode = DWRITE_MEASURING_MODE_GDI_CLASSIC;
 	}
 	
+	return pRenderTarget->DrawGlyphTemp(
+		pFontFace,
+		glyphIndex,
+		glyphMap->fontSize,
+		renderingMode,
+		measuringMode,
+		pGlyphData
+	);
+}
+
+
+// Store the fallback for a glyph that could not be inserted, called with the insert-glyph critical section held
+UINT CFW1GlyphProvider::getFallbackAtlasId(GlyphMap *glyphMap, UINT16 glyphIndex) {
+	UINT glyphAtlasId = glyphMap->glyphPages.getAtlasId(0);
+	if(glyphAtlasId == 0xffffffff || glyphAtlasId == PendingAtlasId)
+		glyphAtlasId = 0;
+	
+	// Remember the fallback so the glyph is inserted again once glyphs are evicted
+	glyphMap->glyphPages.setAtlasId(glyphIndex, glyphAtlasId);
+	glyphMap->fallbackGlyphs.push_back(glyphIndex);
+	
 	return glyphAtlasId;
 }
 
 
+// Create an empty glyph-map, pages are allocated as glyphs are inserted
+CFW1GlyphProvider::GlyphMap* CFW1GlyphProvider::createGlyphMap(FLOAT fontSize, UINT fontFlags, UINT glyphCount) {
+	return new GlyphMap(fontSize, fontFlags, glyphCount);
+}
+
+
+// Delete a glyph-map and its pages
+void CFW1GlyphProvider::deleteGlyphMap(GlyphMap *glyphMap) {
+	delete glyphMap;
+}
+
+
 }// namespace FW1FontWrapper
@@ -4,6 +4,8 @@
 #define IncludeGuard__FW1_CFW1GlyphProvider
 
 #include "CFW1Object.h"
+#include "CFW1HashTable.h"
+#include "CFW1GlyphPages.h"
 
 
 namespace FW1FontWrapper {
@@ -31,6 +33,11 @@ class CFW1GlyphProvider : public CFW1Object<IFW1GlyphProvider> {
 			IDWriteFontFace *pFontFace,
 			UINT FontFlags
 		);
+		virtual UINT STDMETHODCALLTYPE CollectGlyphs(UINT MaxIdleFrames);
+		virtual void STDMETHODCALLTYPE GetMemoryUsage(FW1_GLYPHPROVIDERMEMORYUSAGE *pMemoryUsage);
+		virtual UINT STDMETHODCALLTYPE InsertCompletedGlyphs();
+		virtual UINT STDMETHODCALLTYPE GetPendingGlyphCount();
+		virtual UINT STDMETHODCALLTYPE GetPlaceholderCount();
 	
 	// Public functions
 	public:
@@ -48,25 +55,62 @@ class CFW1GlyphProvider : public CFW1Object<IFW1GlyphProvider> {
 	// Internal types
 	private:
 		struct GlyphMap {
+			GlyphMap(FLOAT size, UINT flags, UINT glyphCount) : fontSize(size), fontFlags(flags), glyphPages(glyphCount) {}
+			
 			FLOAT							fontSize;
 			UINT							fontFlags;
 			
-			UINT							*glyphs;
-			UINT							glyphCount;
+			CFW1GlyphPages					glyphPages;
+			
+			std::vector<UINT16>				fallbackGlyphs;
 		};
 		
+		// Glyph-map entry for a glyph that is queued or being rasterized on a worker thread
+		static const UINT PendingAtlasId = 0xfffffffe;
+		
+		// Font-faces mapped to their font index at most, each holds a reference until destruction
+		// Font-faces past this still resolve, by name under the fonts lock
+		static const size_t MaxMappedFontFaces = 4096;
+		
 		struct FontInfo {
-			IDWriteFontFace					*pFontFace;
 			std::wstring					uniqueName;
 		};
 		
+		struct GlyphJob {
+			GlyphMap						*glyphMap;
+			UINT16							glyphIndex;
+			IDWriteFontFace					*pFontFace;
+		};
+		
+		struct RasterizedGlyph {
+			GlyphMap						*glyphMap;
+			UINT16							glyphIndex;
+			bool							succeeded;
+			
+			FW1_GLYPHMETRICS				metrics;
+			std::vector<UINT8>				pixels;
+		};
+		
 		typedef std::pair<UINT, std::pair<UINT, FLOAT> > FontId;
-		typedef std::map<FontId, GlyphMap*> FontMap;
+		typedef CFW1HashTable<FontId, GlyphMap*> FontMap;
+		typedef CFW1HashTable<IDWriteFontFace*, UINT> FontFaceMap;
 		
 		FontId makeFontId(UINT fontIndex, UINT fontFlags, FLOAT fontSize) {
 			UINT relevantFlags = (fontFlags & (FW1_ALIASED));
 			return std::make_pair(fontIndex, std::make_pair(relevantFlags, fontSize));
 		}
+		
+		static UINT hashFontFace(IDWriteFontFace *pFontFace) {
+			return hashBits(reinterpret_cast<UINT_PTR>(pFontFace));
+		}
+		
+		static UINT hashFontId(const FontId &fontId) {
+			UINT sizeBits;
+			memcpy(&sizeBits, &fontId.second.second, sizeof(sizeBits));
+			
+			UINT64 bits = (static_cast<UINT64>(fontId.first) << 32) | sizeBits;
+			return hashBits(bits ^ (static_cast<UINT64>(fontId.second.first) << 48));
+		}
 	
 	// Internal functions
 	private:
@@ -76,6 +120,23 @@ class CFW1GlyphProvider : public CFW1Object<IFW1GlyphProvider> {
 		std::wstring getUniqueNameFromFontFace(IDWriteFontFace *pFontFace);
 		
 		UINT insertNewGlyph(GlyphMap *glyphMap, UINT16 glyphIndex, IDWriteFontFace *pFontFace);
+		UINT queueNewGlyph(GlyphMap *glyphMap, UINT16 glyphIndex, IDWriteFontFace *pFontFace);
+		void rasterizeQueuedGlyphs();
+		static DWORD WINAPI rasterizeGlyphsProc(LPVOID pParameter);
+		
+		IFW1DWriteRenderTarget* getRenderTarget();
+		void releaseRenderTarget(IFW1DWriteRenderTarget *pRenderTarget);
+		HRESULT drawGlyph(
+			IFW1DWriteRenderTarget *pRenderTarget,
+			const GlyphMap *glyphMap,
+			UINT16 glyphIndex,
+			IDWriteFontFace *pFontFace,
+			FW1_GLYPHIMAGEDATA *pGlyphData
+		);
+		UINT getFallbackAtlasId(GlyphMap *glyphMap, UINT16 glyphIndex);
+		
+		GlyphMap* createGlyphMap(FLOAT fontSize, UINT fontFlags, UINT glyphCount);
+		void deleteGlyphMap(GlyphMap *glyphMap);
 	
 	// Internal data
 	private:
@@ -88,13 +149,25 @@ class CFW1GlyphProvider : public CFW1Object<IFW1GlyphProvider> {
 		
 		IDWriteFontCollection				*m_pFontCollection;
 		std::vector<FontInfo>				m_fonts;
+		FontFaceMap							m_fontFaceMap;
+		std::vector<IDWriteFontFace*>		m_fontFaces;
 		
 		FontMap								m_fontMap;
+		std::vector<GlyphMap*>				m_glyphMaps;
+		std::vector<BOOL>					m_evictedSheets;
+		
+		std::vector<GlyphJob>				m_glyphJobs;
+		std::vector<RasterizedGlyph*>		m_completedGlyphs;
+		UINT								m_activeWorkerCount;
+		UINT								m_maxWorkerCount;
+		UINT								m_pendingGlyphCount;
+		volatile LONG						m_placeholderCount;
 		
 		CRITICAL_SECTION					m_renderTargetsCriticalSection;
 		CRITICAL_SECTION					m_glyphMapsCriticalSection;
 		CRITICAL_SECTION					m_fontsCriticalSection;
 		CRITICAL_SECTION					m_insertGlyphCriticalSection;
+		CRITICAL_SECTION					m_glyphJobsCriticalSection;
 };
 
 
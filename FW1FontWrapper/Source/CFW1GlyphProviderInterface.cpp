@@ -68,46 +68,34 @@ const void* STDMETHODCALLTYPE CFW1GlyphProvider::GetGlyphMapFromFont(
 	// Get font id
 	UINT fontIndex = getFontIndexFromFontFace(pFontFace);
 	FontId fontId = makeFontId(fontIndex, FontFlags, FontSize);
+	UINT fontIdHash = hashFontId(fontId);
 	
-	const void *glyphMap = 0;
-	
-	// Get the glyph-map
-	EnterCriticalSection(&m_glyphMapsCriticalSection);
-	FontMap::iterator it = m_fontMap.find(fontId);
-	if(it != m_fontMap.end())
-		glyphMap = (*it).second;
-	LeaveCriticalSection(&m_glyphMapsCriticalSection);
+	// Get the glyph-map, without locking
+	const void *glyphMap = m_fontMap.find(fontId, fontIdHash, 0);
 	
 	if(glyphMap == 0 && (FontFlags & FW1_NONEWGLYPHS) == 0) {
 		// Create a new glyph-map
-		GlyphMap *newGlyphMap = new GlyphMap;
-		newGlyphMap->fontSize = FontSize;
-		newGlyphMap->fontFlags = FontFlags;
-		newGlyphMap->glyphCount = pFontFace->GetGlyphCount();
-		newGlyphMap->glyphs = new UINT[newGlyphMap->glyphCount];
-		for(UINT i=0; i < newGlyphMap->glyphCount; ++i)
-			newGlyphMap->glyphs[i] = 0xffffffff;
+		GlyphMap *newGlyphMap = createGlyphMap(FontSize, FontFlags, pFontFace->GetGlyphCount());
 		
 		bool needless = false;
 		
 		// Inert the new glyph-map and map the font-id to its index
 		EnterCriticalSection(&m_glyphMapsCriticalSection);
 		
-		it = m_fontMap.find(fontId);
-		if(it != m_fontMap.end()) {
-			glyphMap = (*it).second;
+		glyphMap = m_fontMap.find(fontId, fontIdHash, 0);
+		if(glyphMap != 0) {
 			needless = true;
 		}
 		else {
-			m_fontMap.insert(std::make_pair(fontId, newGlyphMap));
+			m_fontMap.insert(fontId, fontIdHash, newGlyphMap);
+			m_glyphMaps.push_back(newGlyphMap);
 			glyphMap = newGlyphMap;
 		}
 		
 		LeaveCriticalSection(&m_glyphMapsCriticalSection);
 		
 		if(needless) {// Simultaneous creation on two threads
-			delete[] newGlyphMap->glyphs;
-			delete newGlyphMap;
+			deleteGlyphMap(newGlyphMap);
 		}
 		else {
 			UINT glyphAtlasId = insertNewGlyph(newGlyphMap, 0, pFontFace);
@@ -131,17 +119,33 @@ UINT STDMETHODCALLTYPE CFW1GlyphProvider::GetAtlasIdFromGlyphIndex(
 	if(glyphMap == 0)
 		return 0;
 	
-	if(GlyphIndex >= glyphMap->glyphCount)
+	if(GlyphIndex >= glyphMap->glyphPages.getGlyphCount())
 		return 0;
 	
 	// Get the atlas id for this glyph
-	UINT glyphAtlasId = glyphMap->glyphs[GlyphIndex];
-	if(glyphAtlasId == 0xffffffff && (FontFlags & FW1_NONEWGLYPHS) == 0)
-		glyphAtlasId = insertNewGlyph(glyphMap, GlyphIndex, pFontFace);
+	UINT glyphAtlasId = glyphMap->glyphPages.getAtlasId(GlyphIndex);
+	if(glyphAtlasId == 0xffffffff && (FontFlags & FW1_NONEWGLYPHS) == 0) {
+		// The font default-glyph is always inserted right away, as it stands in for the queued glyphs
+		if((FontFlags & FW1_ASYNCGLYPHS) != 0 && GlyphIndex != 0)
+			glyphAtlasId = queueNewGlyph(glyphMap, GlyphIndex, pFontFace);
+		else
+			glyphAtlasId = insertNewGlyph(glyphMap, GlyphIndex, pFontFace);
+	}
+	
+	// Use the font default-glyph as a placeholder until the glyph is inserted
+	if(glyphAtlasId == PendingAtlasId) {
+		InterlockedIncrement(&m_placeholderCount);
+		
+		glyphAtlasId = glyphMap->glyphPages.getAtlasId(0);
+		if(glyphAtlasId == 0xffffffff)
+			glyphAtlasId = GetAtlasIdFromGlyphIndex(pGlyphMap, 0, pFontFace, FontFlags);
+		
+		return glyphAtlasId;
+	}
 	
 	// Fall back to the font default-glyph or the atlas default-glyph on failure
 	if(glyphAtlasId == 0xffffffff) {
-		glyphAtlasId = glyphMap->glyphs[0];
+		glyphAtlasId = glyphMap->glyphPages.getAtlasId(0);
 		
 		if((FontFlags & FW1_NONEWGLYPHS) == 0) {
 			if(glyphAtlasId == 0xffffffff) {
@@ -151,9 +155,12 @@ UINT STDMETHODCALLTYPE CFW1GlyphProvider::GetAtlasIdFromGlyphIndex(
 					glyphAtlasId = GetAtlasIdFromGlyphIndex(pGlyphMap, 0, pFontFace, FontFlags);
 			}
 			
+			// Remember the fallback so the glyph is inserted again once glyphs are evicted
 			EnterCriticalSection(&m_insertGlyphCriticalSection);
-			if(glyphMap->glyphs[GlyphIndex] == 0xffffffff)
-				glyphMap->glyphs[GlyphIndex] = glyphAtlasId;
+			if(glyphMap->glyphPages.getAtlasId(GlyphIndex) == 0xffffffff) {
+				glyphMap->glyphPages.setAtlasId(GlyphIndex, glyphAtlasId);
+				glyphMap->fallbackGlyphs.push_back(GlyphIndex);
+			}
 			LeaveCriticalSection(&m_insertGlyphCriticalSection);
 		}
 		
@@ -165,4 +172,164 @@ UINT STDMETHODCALLTYPE CFW1GlyphProvider::GetAtlasIdFromGlyphIndex(
 }
 
 
+// Evict unused glyphs from the atlas and clear their glyph-map entries
+UINT STDMETHODCALLTYPE CFW1GlyphProvider::CollectGlyphs(UINT MaxIdleFrames) {
+	EnterCriticalSection(&m_insertGlyphCriticalSection);
+	
+	// The scratch array only grows with the atlas, so collecting does not allocate every frame
+	UINT sheetCount = m_pGlyphAtlas->GetSheetCount();
+	if(m_evictedSheets.size() < sheetCount + 1)
+		m_evictedSheets.resize(sheetCount + 1);
+	BOOL *evictedSheets = &m_evictedSheets[0];
+	
+	UINT evictedCount = m_pGlyphAtlas->EvictGlyphs(MaxIdleFrames, evictedSheets, sheetCount);
+	
+	if(evictedCount > 0) {
+		EnterCriticalSection(&m_glyphMapsCriticalSection);
+		
+		for(size_t k=0; k < m_glyphMaps.size(); ++k) {
+			GlyphMap *glyphMap = m_glyphMaps[k];
+			
+			// Fallbacks may point into an evicted sheet, and the glyph may fit now
+			for(size_t i=0; i < glyphMap->fallbackGlyphs.size(); ++i)
+				glyphMap->glyphPages.setAtlasId(glyphMap->fallbackGlyphs[i], 0xffffffff);
+			glyphMap->fallbackGlyphs.clear();
+			
+			// Pages are kept once allocated, only the entries are cleared
+			for(UINT i=0; i < glyphMap->glyphPages.getPageCount(); ++i) {
+				UINT *page = glyphMap->glyphPages.getPage(i);
+				if(page == 0)
+					continue;
+				
+				for(UINT j=0; j < CFW1GlyphPages::PageSize; ++j) {
+					UINT glyphAtlasId = page[j];
+					if(glyphAtlasId != 0xffffffff && glyphAtlasId != PendingAtlasId && (glyphAtlasId >> 16) < sheetCount && evictedSheets[glyphAtlasId >> 16])
+						page[j] = 0xffffffff;
+				}
+			}
+		}
+		
+		LeaveCriticalSection(&m_glyphMapsCriticalSection);
+	}
+	
+	LeaveCriticalSection(&m_insertGlyphCriticalSection);
+	
+	return evictedCount;
+}
+
+
+// Insert glyphs rasterized on worker threads into the atlas
+UINT STDMETHODCALLTYPE CFW1GlyphProvider::InsertCompletedGlyphs() {
+	std::vector<RasterizedGlyph*> completedGlyphs;
+	
+	EnterCriticalSection(&m_glyphJobsCriticalSection);
+	completedGlyphs.swap(m_completedGlyphs);
+	LeaveCriticalSection(&m_glyphJobsCriticalSection);
+	
+	if(completedGlyphs.empty())
+		return 0;
+	
+	// Insert the whole batch under one lock
+	EnterCriticalSection(&m_insertGlyphCriticalSection);
+	
+	for(size_t i=0; i < completedGlyphs.size(); ++i) {
+		RasterizedGlyph *rasterizedGlyph = completedGlyphs[i];
+		
+		UINT glyphAtlasId = 0xffffffff;
+		if(rasterizedGlyph->succeeded) {
+			const UINT8 *pGlyphPixels = rasterizedGlyph->pixels.empty() ? NULL : &rasterizedGlyph->pixels[0];
+			
+			glyphAtlasId = m_pGlyphAtlas->InsertGlyph(
+				&rasterizedGlyph->metrics,
+				pGlyphPixels,
+				rasterizedGlyph->metrics.Width,
+				1
+			);
+		}
+		
+		if(glyphAtlasId != 0xffffffff)
+			rasterizedGlyph->glyphMap->glyphPages.setAtlasId(rasterizedGlyph->glyphIndex, glyphAtlasId);
+		else
+			getFallbackAtlasId(rasterizedGlyph->glyphMap, rasterizedGlyph->glyphIndex);
+		
+		delete rasterizedGlyph;
+	}
+	
+	LeaveCriticalSection(&m_insertGlyphCriticalSection);
+	
+	UINT insertedCount = static_cast<UINT>(completedGlyphs.size());
+	
+	EnterCriticalSection(&m_glyphJobsCriticalSection);
+	m_pendingGlyphCount -= insertedCount;
+	LeaveCriticalSection(&m_glyphJobsCriticalSection);
+	
+	return insertedCount;
+}
+
+
+// Get the number of glyphs not yet inserted by InsertCompletedGlyphs
+UINT STDMETHODCALLTYPE CFW1GlyphProvider::GetPendingGlyphCount() {
+	EnterCriticalSection(&m_glyphJobsCriticalSection);
+	UINT pendingGlyphCount = m_pendingGlyphCount;
+	LeaveCriticalSection(&m_glyphJobsCriticalSection);
+	
+	return pendingGlyphCount;
+}
+
+
+// Get the number of placeholders returned for glyphs not yet inserted
+UINT STDMETHODCALLTYPE CFW1GlyphProvider::GetPlaceholderCount() {
+	return static_cast<UINT>(m_placeholderCount);
+}
+
+
+// Get the memory taken up by glyph-maps
+void STDMETHODCALLTYPE CFW1GlyphProvider::GetMemoryUsage(FW1_GLYPHPROVIDERMEMORYUSAGE *pMemoryUsage) {
+	if(pMemoryUsage == NULL)
+		return;
+	
+	ZeroMemory(pMemoryUsage, sizeof(*pMemoryUsage));
+	
+	EnterCriticalSection(&m_insertGlyphCriticalSection);
+	EnterCriticalSection(&m_glyphMapsCriticalSection);
+	
+	pMemoryUsage->GlyphMapBytes += m_fontMap.getMemoryUsage();
+	
+	for(size_t k=0; k < m_glyphMaps.size(); ++k) {
+		const GlyphMap *glyphMap = m_glyphMaps[k];
+		
+		++pMemoryUsage->GlyphMapCount;
+		pMemoryUsage->GlyphMapBytes += sizeof(GlyphMap) + glyphMap->glyphPages.getPageCount() * sizeof(UINT*);
+		pMemoryUsage->GlyphMapBytes += glyphMap->fallbackGlyphs.capacity() * sizeof(UINT16);
+		pMemoryUsage->DenseGlyphMapBytes += sizeof(GlyphMap) + glyphMap->glyphPages.getGlyphCount() * sizeof(UINT);
+		
+		for(UINT i=0; i < glyphMap->glyphPages.getPageCount(); ++i) {
+			const UINT *page = glyphMap->glyphPages.getPage(i);
+			if(page == 0)
+				continue;
+			
+			++pMemoryUsage->GlyphPageCount;
+			pMemoryUsage->GlyphMapBytes += CFW1GlyphPages::PageSize * sizeof(UINT);
+			
+			for(UINT j=0; j < CFW1GlyphPages::PageSize; ++j) {
+				if(page[j] != 0xffffffff && page[j] != PendingAtlasId)
+					++pMemoryUsage->MappedGlyphCount;
+			}
+		}
+	}
+	
+	LeaveCriticalSection(&m_glyphMapsCriticalSection);
+	LeaveCriticalSection(&m_insertGlyphCriticalSection);
+	
+	EnterCriticalSection(&m_fontsCriticalSection);
+	pMemoryUsage->FontCount = static_cast<UINT>(m_fonts.size());
+	LeaveCriticalSection(&m_fontsCriticalSection);
+	
+	EnterCriticalSection(&m_renderTargetsCriticalSection);
+	pMemoryUsage->RenderTargetCount = static_cast<UINT>(m_glyphRenderTargets.size());
+	pMemoryUsage->RenderTargetBytes = static_cast<SIZE_T>(pMemoryUsage->RenderTargetCount) * m_maxGlyphWidth * m_maxGlyphHeight * 4;
+	LeaveCriticalSection(&m_renderTargetsCriticalSection);
+}
+
+
 }// namespace FW1FontWrapper
@@ -18,7 +18,9 @@ CFW1GlyphSheet::CFW1GlyphSheet() :
 	m_allowOversizedGlyph(false),
 	
 	m_textureData(0),
+	m_textureDataSize(0),
 	m_glyphCoords(0),
+	m_glyphLastUsed(0),
 	m_maxGlyphCount(0),
 	m_glyphCount(0),
 	m_mipLevelCount(0),
@@ -34,7 +36,8 @@ CFW1GlyphSheet::CFW1GlyphSheet() :
 	m_closed(false),
 	m_static(false),
 	
-	m_heightRange(0),
+	m_skyline(0),
+	m_usedBlockArea(0),
 	
 	m_updatedGlyphCount(0)
 {
@@ -48,6 +51,7 @@ CFW1GlyphSheet::CFW1GlyphSheet() :
 CFW1GlyphSheet::~CFW1GlyphSheet() {
 	delete[] m_textureData;
 	delete[] m_glyphCoords;
+	delete[] m_glyphLastUsed;
 	
 	SAFE_RELEASE(m_pDevice);
 	
@@ -56,7 +60,7 @@ CFW1GlyphSheet::~CFW1GlyphSheet() {
 	SAFE_RELEASE(m_pCoordBuffer);
 	SAFE_RELEASE(m_pCoordBufferSRV);
 	
-	delete m_heightRange;
+	delete m_skyline;
 	
 	DeleteCriticalSection(&m_sheetCriticalSection);
 	DeleteCriticalSection(&m_flushCriticalSection);
@@ -121,12 +125,16 @@ HRESULT CFW1GlyphSheet::initGlyphSheet(
 		textureSize += mipSize;
 	}
 	
+	m_textureDataSize = textureSize;
 	m_textureData = new UINT8[textureSize];
 	ZeroMemory(m_textureData, textureSize);
 	
 	m_glyphCoords = new FW1_GLYPHCOORDS[m_maxGlyphCount];
 	
-	m_heightRange = new HeightRange(m_sheetWidth / m_alignWidth);
+	m_glyphLastUsed = new UINT[m_maxGlyphCount];
+	ZeroMemory(m_glyphLastUsed, m_maxGlyphCount * sizeof(UINT));
+	
+	m_skyline = new CFW1Skyline(m_sheetWidth / m_alignWidth);
 	
 	// Device texture/coord-buffer
 	hResult = createDeviceResources();
@@ -220,56 +228,4 @@ HRESULT CFW1GlyphSheet::createDeviceResources() {
 }
 
 
-// Height-range helper class, used to fit glyphs in the sheet
-
-CFW1GlyphSheet::HeightRange::HeightRange(UINT totalWidth) : m_totalWidth(totalWidth) {
-	m_heights = new UINT[m_totalWidth];
-	ZeroMemory(m_heights, m_totalWidth * sizeof(UINT));
-}
-
-CFW1GlyphSheet::HeightRange::~HeightRange() {
-	delete[] m_heights;
-}
-
-UINT CFW1GlyphSheet::HeightRange::findMin(UINT width, UINT *outMin) {
-	if(width > m_totalWidth)
-		width = m_totalWidth;
-	
-	UINT currentMax = findMax(0, width);
-	UINT currentMin = currentMax;
-	UINT minX = 0;
-	
-	for(UINT i=1; i < m_totalWidth-width; ++i) {
-		if(m_heights[i+width-1] >= currentMax)
-			currentMax = m_heights[i+width-1];
-		else if(m_heights[i-1] == currentMax) {
-			currentMax = findMax(i, width);
-			if(currentMax < currentMin) {
-				currentMin = currentMax;
-				minX = i;
-			}
-		}
-	}
-	
-	*outMin = currentMin;
-	return minX;
-}
-
-void CFW1GlyphSheet::HeightRange::update(UINT startX, UINT width, UINT newHeight) {
-	if(width > m_totalWidth)
-		width = m_totalWidth;
-	
-	for(UINT i=0; i < width; ++i)
-		m_heights[startX+i] = newHeight;
-}
-
-UINT CFW1GlyphSheet::HeightRange::findMax(UINT startX, UINT width) {
-	UINT currentMax = m_heights[startX];
-	for(UINT i=1; i < width; ++i)
-		currentMax = std::max(currentMax, m_heights[startX+i]);
-	
-	return currentMax;
-}
-
-
 }// namespace FW1FontWrapper
@@ -4,6 +4,7 @@
 #define IncludeGuard__FW1_CFW1GlyphSheet
 
 #include "CFW1Object.h"
+#include "CFW1Skyline.h"
 
 
 namespace FW1FontWrapper {
@@ -33,6 +34,12 @@ class CFW1GlyphSheet : public CFW1Object<IFW1GlyphSheet> {
 		);
 		virtual void STDMETHODCALLTYPE CloseSheet();
 		virtual void STDMETHODCALLTYPE Flush(ID3D11DeviceContext *pContext);
+		
+		virtual void STDMETHODCALLTYPE GetOccupancy(FW1_GLYPHSHEETOCCUPANCY *pOccupancy);
+		
+		virtual void STDMETHODCALLTYPE MarkGlyphsUsed(const FW1_GLYPHVERTEX *pVertices, UINT VertexCount, UINT Frame);
+		virtual UINT STDMETHODCALLTYPE GetUsedGlyphCount(UINT SinceFrame);
+		virtual HRESULT STDMETHODCALLTYPE ResetSheet();
 	
 	// Public functions
 	public:
@@ -58,25 +65,6 @@ class CFW1GlyphSheet : public CFW1Object<IFW1GlyphSheet> {
 			UINT					bottom;
 		};
 		
-		class HeightRange {
-			public:
-				HeightRange(UINT totalWidth);
-				~HeightRange();
-				
-				UINT findMin(UINT width, UINT *outMin);
-				void update(UINT startX, UINT width, UINT newHeight);
-			
-			private:
-				HeightRange();
-				HeightRange(const HeightRange&);
-				HeightRange& operator=(const HeightRange&);
-				
-				UINT findMax(UINT startX, UINT width);
-				
-				UINT				*m_heights;
-				UINT				m_totalWidth;
-		};
-		
 		class CriticalSectionLock {
 			public:
 				CriticalSectionLock(LPCRITICAL_SECTION pCriticalSection) : m_pCriticalSection(pCriticalSection) {
@@ -112,7 +100,9 @@ class CFW1GlyphSheet : public CFW1Object<IFW1GlyphSheet> {
 		UINT						m_alignWidth;
 		
 		UINT8						*m_textureData;
+		UINT						m_textureDataSize;
 		FW1_GLYPHCOORDS				*m_glyphCoords;
+		UINT						*m_glyphLastUsed;
 		UINT						m_maxGlyphCount;
 		UINT						m_glyphCount;
 		
@@ -126,7 +116,8 @@ class CFW1GlyphSheet : public CFW1Object<IFW1GlyphSheet> {
 		bool						m_closed;
 		bool						m_static;
 		
-		HeightRange					*m_heightRange;
+		CFW1Skyline					*m_skyline;
+		UINT						m_usedBlockArea;
 		
 		UINT						m_updatedGlyphCount;
 		RectUI						m_dirtyRect;
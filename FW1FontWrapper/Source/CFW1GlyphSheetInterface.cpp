@@ -124,8 +124,8 @@ UINT STDMETHODCALLTYPE CFW1GlyphSheet::InsertGlyph(
 		if(m_alignWidth + width + m_alignWidth > m_sheetWidth)
 			return 0xffffffff;
 		
-		// Position the glyph at the lowest Y possible (fills reasonably well with different sized glyphs)
-		blockX = m_heightRange->findMin(blockWidth, &blockY);
+		// Position the glyph at the lowest Y possible, preferring the spot that wastes the least space below it
+		blockX = m_skyline->findPosition(blockWidth, &blockY);
 		
 		positionX = m_alignWidth + blockX * m_alignWidth;
 		positionY = m_alignWidth + blockY * m_alignWidth;
@@ -141,7 +141,8 @@ UINT STDMETHODCALLTYPE CFW1GlyphSheet::InsertGlyph(
 		positionY = m_alignWidth;
 	}
 	
-	m_heightRange->update(blockX, blockWidth, blockY + blockHeight);
+	m_skyline->addRect(blockX, blockWidth, blockY + blockHeight);
+	m_usedBlockArea += blockWidth * blockHeight;
 	
 	// Store glyph coordinates
 	FLOAT coordOffset = static_cast<FLOAT>(m_alignWidth) * 0.5f;
@@ -197,6 +198,73 @@ UINT STDMETHODCALLTYPE CFW1GlyphSheet::InsertGlyph(
 }
 
 
+// Get how well the glyphs in the sheet are packed
+void STDMETHODCALLTYPE CFW1GlyphSheet::GetOccupancy(FW1_GLYPHSHEETOCCUPANCY *pOccupancy) {
+	CriticalSectionLock lock(&m_sheetCriticalSection);
+	
+	UINT blockPixels = m_alignWidth * m_alignWidth;
+	UINT skylineArea = m_skyline->getArea();
+	
+	pOccupancy->UsedArea = m_usedBlockArea * blockPixels;
+	pOccupancy->WastedArea = (skylineArea > m_usedBlockArea ? skylineArea - m_usedBlockArea : 0) * blockPixels;
+	pOccupancy->SkylineHeight = m_skyline->getMaxHeight() * m_alignWidth;
+	pOccupancy->SkylineSegmentCount = m_skyline->getSegmentCount();
+	pOccupancy->Occupancy = static_cast<FLOAT>(pOccupancy->UsedArea) / static_cast<FLOAT>(m_sheetWidth * m_sheetHeight);
+	pOccupancy->Fragmentation = skylineArea > 0 ? static_cast<FLOAT>(pOccupancy->WastedArea) / static_cast<FLOAT>(skylineArea * blockPixels) : 0.0f;
+}
+
+
+// Stamp glyphs with the frame they were drawn in
+void STDMETHODCALLTYPE CFW1GlyphSheet::MarkGlyphsUsed(const FW1_GLYPHVERTEX *pVertices, UINT VertexCount, UINT Frame) {
+	for(UINT i=0; i < VertexCount; ++i) {
+		UINT glyphIndex = pVertices[i].GlyphIndex & 0xffff;
+		if(glyphIndex < m_maxGlyphCount)
+			m_glyphLastUsed[glyphIndex] = Frame;
+	}
+}
+
+
+// Count the glyphs drawn since a frame
+UINT STDMETHODCALLTYPE CFW1GlyphSheet::GetUsedGlyphCount(UINT SinceFrame) {
+	CriticalSectionLock lock(&m_sheetCriticalSection);
+	
+	UINT usedCount = 0;
+	for(UINT i=0; i < m_glyphCount; ++i) {
+		if(m_glyphLastUsed[i] >= SinceFrame)
+			++usedCount;
+	}
+	
+	return usedCount;
+}
+
+
+// Remove all glyphs and reopen the sheet
+HRESULT STDMETHODCALLTYPE CFW1GlyphSheet::ResetSheet() {
+	CriticalSectionLock flushLock(&m_flushCriticalSection);
+	CriticalSectionLock lock(&m_sheetCriticalSection);
+	
+	// Static sheets have released their RAM copy of the texture
+	if(m_textureData == 0)
+		m_textureData = new UINT8[m_textureDataSize];
+	ZeroMemory(m_textureData, m_textureDataSize);
+	
+	// The device texture keeps the old pixels, but every new glyph uploads its own padded rect so they are never sampled
+	delete m_skyline;
+	m_skyline = new CFW1Skyline(m_sheetWidth / m_alignWidth);
+	m_usedBlockArea = 0;
+	
+	ZeroMemory(m_glyphLastUsed, m_maxGlyphCount * sizeof(UINT));
+	ZeroMemory(&m_dirtyRect, sizeof(m_dirtyRect));
+	
+	m_glyphCount = 0;
+	m_updatedGlyphCount = 0;
+	m_closed = false;
+	m_static = false;
+	
+	return S_OK;
+}
+
+
 // Disallow insertion of additional glyphs in this sheet
 void STDMETHODCALLTYPE CFW1GlyphSheet::CloseSheet() {
 	EnterCriticalSection(&m_sheetCriticalSection);
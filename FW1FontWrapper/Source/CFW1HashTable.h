@@ -0,0 +1,146 @@
+// CFW1HashTable.h
+
+#ifndef IncludeGuard__FW1_CFW1HashTable
+#define IncludeGuard__FW1_CFW1HashTable
+
+
+namespace FW1FontWrapper {
+
+
+// Finalizer from MurmurHash3, spreads the bits so linear probing does not cluster
+inline UINT hashBits(UINT64 bits) {
+	bits ^= bits >> 33;
+	bits *= 0xff51afd7ed558ccdULL;
+	bits ^= bits >> 33;
+	bits *= 0xc4ceb9fe1a85ec53ULL;
+	bits ^= bits >> 33;
+	return static_cast<UINT>(bits);
+}
+
+
+// Open-addressed hash table that never removes entries
+// Lookups do not lock, inserts must be serialized by the caller
+// Used by CFW1GlyphProvider, it has no device dependencies so it can be used on its own
+template<typename KeyType, typename ValueType>
+class CFW1HashTable {
+	// Public functions
+	public:
+		CFW1HashTable() : m_count(0) {
+			m_table = createTable(16);
+		}
+		~CFW1HashTable() {
+			deleteTable(m_table);
+			for(size_t i=0; i < m_retiredTables.size(); ++i)
+				deleteTable(m_retiredTables[i]);
+		}
+		
+		ValueType find(const KeyType &key, UINT hash, ValueType notFound) const {
+			const Table *table = m_table;
+			_ReadBarrier();
+			
+			for(UINT i = hash & table->mask; ; i = (i + 1) & table->mask) {
+				const Entry &entry = table->entries[i];
+				if(entry.used == 0)
+					return notFound;
+				_ReadBarrier();
+				
+				if(entry.hash == hash && entry.key == key)
+					return entry.value;
+			}
+		}
+		
+		void insert(const KeyType &key, UINT hash, ValueType value) {
+			// Keep the load at most one half, so every probe ends at an empty entry
+			if((m_count + 1) * 2 > m_table->mask + 1) {
+				Table *newTable = createTable((m_table->mask + 1) * 2);
+				for(UINT i=0; i <= m_table->mask; ++i) {
+					const Entry &entry = m_table->entries[i];
+					if(entry.used != 0)
+						insertEntry(newTable, entry.key, entry.hash, entry.value);
+				}
+				
+				// Readers may still be probing the old table, so it is kept until destruction
+				_WriteBarrier();
+				MemoryBarrier();
+				
+				Table *oldTable = m_table;
+				m_retiredTables.push_back(oldTable);
+				m_table = newTable;
+			}
+			
+			insertEntry(m_table, key, hash, value);
+			++m_count;
+		}
+		
+		UINT getCount() const {
+			return m_count;
+		}
+		
+		SIZE_T getMemoryUsage() const {
+			SIZE_T bytes = (m_table->mask + 1) * sizeof(Entry);
+			for(size_t i=0; i < m_retiredTables.size(); ++i)
+				bytes += (m_retiredTables[i]->mask + 1) * sizeof(Entry);
+			return bytes;
+		}
+	
+	// Internal types
+	private:
+		CFW1HashTable(const CFW1HashTable&);
+		CFW1HashTable& operator=(const CFW1HashTable&);
+		
+		struct Entry {
+			KeyType				key;
+			UINT				hash;
+			ValueType			value;
+			volatile LONG		used;
+		};
+		
+		struct Table {
+			Entry				*entries;
+			UINT				mask;
+		};
+	
+	// Internal functions
+	private:
+		static Table* createTable(UINT capacity) {
+			Table *table = new Table;
+			table->entries = new Entry[capacity];
+			table->mask = capacity - 1;
+			for(UINT i=0; i < capacity; ++i)
+				table->entries[i].used = 0;
+			return table;
+		}
+		static void deleteTable(Table *table) {
+			delete[] table->entries;
+			delete table;
+		}
+		
+		// Fill in the entry before marking it used, so readers never see a partial entry
+		static void insertEntry(Table *table, const KeyType &key, UINT hash, ValueType value) {
+			UINT i = hash & table->mask;
+			while(table->entries[i].used != 0)
+				i = (i + 1) & table->mask;
+			
+			Entry &entry = table->entries[i];
+			entry.key = key;
+			entry.hash = hash;
+			entry.value = value;
+			
+			_WriteBarrier();
+			MemoryBarrier();
+			
+			entry.used = 1;
+		}
+	
+	// Internal data
+	private:
+		Table * volatile		m_table;
+		std::vector<Table*>		m_retiredTables;
+		UINT					m_count;
+};
+
+
+}// namespace FW1FontWrapper
+
+
+#endif// IncludeGuard__FW1_CFW1HashTable
@@ -0,0 +1,147 @@
+// CFW1Skyline.cpp
+
+#include "FW1Precompiled.h"
+
+#include "CFW1Skyline.h"
+
+
+namespace FW1FontWrapper {
+
+
+// Construct
+CFW1Skyline::CFW1Skyline(UINT totalWidth) : m_totalWidth(totalWidth) {
+	Segment ground = { 0, m_totalWidth, 0 };
+	m_segments.push_back(ground);
+}
+
+// Find the x position where a rect of width gets the lowest top, ties go to the position that wastes the least area below the rect
+// The rect is tried against the left and the right end of every segment, so it can fill a gap flush with either neighbour
+UINT CFW1Skyline::findPosition(UINT width, UINT *outY) {
+	if(width > m_totalWidth)
+		width = m_totalWidth;
+	
+	UINT bestX = 0;
+	UINT bestY = UINT_MAX;
+	UINT bestWaste = UINT_MAX;
+	
+	for(size_t i=0; i < m_segments.size(); ++i) {
+		const Segment &segment = m_segments[i];
+		
+		// Left-aligned on the segment
+		if(segment.x + width <= m_totalWidth)
+			rankPosition(i, segment.x, width, bestX, bestY, bestWaste);
+		
+		// Right-aligned on the segment, starting in the first segment the rect reaches back into
+		UINT segmentEnd = segment.x + segment.width;
+		if(segmentEnd >= width && segmentEnd - width != segment.x) {
+			UINT startX = segmentEnd - width;
+			size_t first = i;
+			while(m_segments[first].x > startX)
+				--first;
+			
+			rankPosition(first, startX, width, bestX, bestY, bestWaste);
+		}
+	}
+	
+	*outY = bestY;
+	return bestX;
+}
+
+// Rank the rect at startX against the best position so far, first is the segment startX is in
+void CFW1Skyline::rankPosition(size_t first, UINT startX, UINT width, UINT &bestX, UINT &bestY, UINT &bestWaste) const {
+	// The rect rests on the highest segment it spans
+	UINT y = 0;
+	UINT endX = startX + width;
+	for(size_t j=first; j < m_segments.size() && m_segments[j].x < endX; ++j)
+		y = std::max(y, m_segments[j].y);
+	
+	if(y > bestY)
+		return;
+	
+	UINT waste = 0;
+	for(size_t j=first; j < m_segments.size() && m_segments[j].x < endX; ++j) {
+		UINT spanned = std::min(m_segments[j].x + m_segments[j].width, endX) - std::max(m_segments[j].x, startX);
+		waste += (y - m_segments[j].y) * spanned;
+	}
+	
+	if(y < bestY || waste < bestWaste) {
+		bestX = startX;
+		bestY = y;
+		bestWaste = waste;
+	}
+}
+
+// Raise the skyline to newHeight from startX to startX + width
+void CFW1Skyline::addRect(UINT startX, UINT width, UINT newHeight) {
+	if(startX >= m_totalWidth)
+		return;
+	if(width > m_totalWidth - startX)
+		width = m_totalWidth - startX;
+	
+	UINT endX = startX + width;
+	Segment raised = { startX, width, newHeight };
+	bool inserted = false;
+	
+	m_scratch.clear();
+	for(size_t i=0; i < m_segments.size(); ++i) {
+		const Segment &segment = m_segments[i];
+		UINT segmentEnd = segment.x + segment.width;
+		
+		if(segmentEnd <= startX || segment.x >= endX) {
+			if(segment.x >= endX && !inserted) {
+				m_scratch.push_back(raised);
+				inserted = true;
+			}
+			m_scratch.push_back(segment);
+			continue;
+		}
+		
+		// Keep the parts of the segment on either side of the rect
+		if(segment.x < startX) {
+			Segment left = { segment.x, startX - segment.x, segment.y };
+			m_scratch.push_back(left);
+		}
+		if(!inserted) {
+			m_scratch.push_back(raised);
+			inserted = true;
+		}
+		if(segmentEnd > endX) {
+			Segment right = { endX, segmentEnd - endX, segment.y };
+			m_scratch.push_back(right);
+		}
+	}
+	if(!inserted)
+		m_scratch.push_back(raised);
+	
+	// Merge neighbours of the same height to keep the list short
+	m_segments.clear();
+	for(size_t i=0; i < m_scratch.size(); ++i) {
+		if(!m_segments.empty() && m_segments.back().y == m_scratch[i].y)
+			m_segments.back().width += m_scratch[i].width;
+		else
+			m_segments.push_back(m_scratch[i]);
+	}
+}
+
+UINT CFW1Skyline::getArea() const {
+	UINT area = 0;
+	for(size_t i=0; i < m_segments.size(); ++i)
+		area += m_segments[i].width * m_segments[i].y;
+	
+	return area;
+}
+
+UINT CFW1Skyline::getMaxHeight() const {
+	UINT maxHeight = 0;
+	for(size_t i=0; i < m_segments.size(); ++i)
+		maxHeight = std::max(maxHeight, m_segments[i].y);
+	
+	return maxHeight;
+}
+
+UINT CFW1Skyline::getSegmentCount() const {
+	return static_cast<UINT>(m_segments.size());
+}
+
+
+}// namespace FW1FontWrapper
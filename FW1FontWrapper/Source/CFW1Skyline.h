@@ -0,0 +1,51 @@
+// CFW1Skyline.h
+
+#ifndef IncludeGuard__FW1_CFW1Skyline
+#define IncludeGuard__FW1_CFW1Skyline
+
+
+namespace FW1FontWrapper {
+
+
+// Top edge of the filled part of a glyph sheet, stored as a list of flat segments from left to right
+// Used by CFW1GlyphSheet to fit glyphs, it has no device dependencies so it can be used on its own
+class CFW1Skyline {
+	// Public functions
+	public:
+		CFW1Skyline(UINT totalWidth);
+		
+		UINT findPosition(UINT width, UINT *outY);
+		void addRect(UINT startX, UINT width, UINT newHeight);
+		
+		UINT getArea() const;
+		UINT getMaxHeight() const;
+		UINT getSegmentCount() const;
+	
+	// Internal types
+	private:
+		CFW1Skyline();
+		CFW1Skyline(const CFW1Skyline&);
+		CFW1Skyline& operator=(const CFW1Skyline&);
+		
+		struct Segment {
+			UINT			x;
+			UINT			width;
+			UINT			y;
+		};
+	
+	// Internal functions
+	private:
+		void rankPosition(size_t first, UINT startX, UINT width, UINT &bestX, UINT &bestY, UINT &bestWaste) const;
+	
+	// Internal data
+	private:
+		std::vector<Segment>	m_segments;
+		std::vector<Segment>	m_scratch;
+		UINT					m_totalWidth;
+};
+
+
+}// namespace FW1FontWrapper
+
+
+#endif// IncludeGuard__FW1_CFW1Skyline
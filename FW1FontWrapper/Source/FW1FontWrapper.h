@@ -85,6 +85,9 @@ enum FW1_TEXT_FLAG {
 	/// <summary>A text-layout will be run through DirectWrite and new fonts will be prepared, but no actual drawing will take place, and no additional glyphs will be cached.</summary>
 	FW1_ANALYZEONLY = 0x8000,
 	
+	/// <summary>New glyphs are rasterized on worker threads instead of while the text is laid out, and the font's default glyph is used in their place until they are inserted into the atlas by IFW1GlyphProvider::InsertCompletedGlyphs.</summary>
+	FW1_ASYNCGLYPHS = 0x10000,
+	
 	/// <summary>Don't use.</summary>
 	FW1_UNUSED = 0xffffffff
 };
@@ -133,6 +136,56 @@ struct FW1_GLYPHSHEETDESC {
 	UINT MipLevels;
 };
 
+/// <summary>Describes how well the glyphs in a sheet are packed.</summary>
+/// <remarks>This structure is filled in by IFW1GlyphSheet::GetOccupancy.</remarks>
+struct FW1_GLYPHSHEETOCCUPANCY {
+	/// <summary>The number of pixels taken up by glyphs, including their padding.</summary>
+	UINT UsedArea;
+	
+	/// <summary>The number of pixels below the skyline that are not taken up by glyphs. These can not be used by later glyphs.</summary>
+	UINT WastedArea;
+	
+	/// <summary>The height of the skyline's highest point, in pixels.</summary>
+	UINT SkylineHeight;
+	
+	/// <summary>The number of segments in the skyline. A high count compared to the sheet width means the free space is fragmented.</summary>
+	UINT SkylineSegmentCount;
+	
+	/// <summary>The fraction of the sheet's area taken up by glyphs, between 0 and 1.</summary>
+	FLOAT Occupancy;
+	
+	/// <summary>The fraction of the area below the skyline that is wasted, between 0 and 1.</summary>
+	FLOAT Fragmentation;
+};
+
+/// <summary>Describes the memory used by a glyph-provider.</summary>
+/// <remarks>This structure is filled in by IFW1GlyphProvider::GetMemoryUsage.</remarks>
+struct FW1_GLYPHPROVIDERMEMORYUSAGE {
+	/// <summary>The number of fonts the glyph-provider has seen.</summary>
+	UINT FontCount;
+	
+	/// <summary>The number of glyph-maps, one for each font, size and flags combination.</summary>
+	UINT GlyphMapCount;
+	
+	/// <summary>The number of allocated glyph-map pages. A page holds the atlas IDs of 256 consecutive glyphs.</summary>
+	UINT GlyphPageCount;
+	
+	/// <summary>The number of glyphs that have been given an atlas ID.</summary>
+	UINT MappedGlyphCount;
+	
+	/// <summary>The number of bytes used by glyph-maps and their pages.</summary>
+	SIZE_T GlyphMapBytes;
+	
+	/// <summary>The number of bytes the glyph-maps would use with one entry for every glyph in their fonts.</summary>
+	SIZE_T DenseGlyphMapBytes;
+	
+	/// <summary>The number of cached render-targets used to draw glyph images.</summary>
+	UINT RenderTargetCount;
+	
+	/// <summary>The approximate number of bytes used by the bitmaps of the cached render-targets.</summary>
+	SIZE_T RenderTargetBytes;
+};
+
 /// <summary>Metrics for a glyph image.</summary>
 /// <remarks>This structure is filled in as part of the FW1_GLYPHIMAGEDATA structure when a glyph-image is rendered by IFW1DWriteRenderTarget::DrawGlyphTemp.</remarks>
 struct FW1_GLYPHMETRICS {
@@ -378,6 +431,41 @@ MIDL_INTERFACE("60CAB266-C805-461d-82C0-392472EECEFA") IFW1GlyphSheet : public I
 		virtual void STDMETHODCALLTYPE Flush(
 			__in ID3D11DeviceContext *pContext
 		) = 0;
+		
+		/// <summary>Get how well the glyphs in the sheet are packed.</summary>
+		/// <remarks></remarks>
+		/// <returns>Returns nothing.</returns>
+		/// <param name="pOccupancy">Pointer to an occupancy report.</param>
+		virtual void STDMETHODCALLTYPE GetOccupancy(
+			__out FW1_GLYPHSHEETOCCUPANCY *pOccupancy
+		) = 0;
+		
+		/// <summary>Stamp glyphs in the sheet with the frame they were last drawn in.</summary>
+		/// <remarks>The GlyphIndex of each vertex is the index of the glyph in this sheet, as returned by IFW1TextGeometry::GetGlyphVerticesTemp.<br/>
+		/// This method is not thread-safe.</remarks>
+		/// <returns>No return value.</returns>
+		/// <param name="pVertices">Pointer to the glyph vertices to stamp.</param>
+		/// <param name="VertexCount">The number of vertices.</param>
+		/// <param name="Frame">The frame to stamp the glyphs with.</param>
+		virtual void STDMETHODCALLTYPE MarkGlyphsUsed(
+			__in const FW1_GLYPHVERTEX *pVertices,
+			__in UINT VertexCount,
+			__in UINT Frame
+		) = 0;
+		
+		/// <summary>Get the number of glyphs in the sheet that have been drawn since a frame.</summary>
+		/// <remarks>See IFW1GlyphSheet::MarkGlyphsUsed.</remarks>
+		/// <returns>The number of glyphs stamped with <i>SinceFrame</i> or a later frame.</returns>
+		/// <param name="SinceFrame">The oldest frame a glyph can be stamped with to be counted.</param>
+		virtual UINT STDMETHODCALLTYPE GetUsedGlyphCount(
+			__in UINT SinceFrame
+		) = 0;
+		
+		/// <summary>Remove all glyphs from the sheet and open it for new glyphs.</summary>
+		/// <remarks>Glyph indices previously returned by the sheet are no longer valid after this call, and any geometry referencing them must be rebuilt.</remarks>
+		/// <returns>Standard HRESULT error code.</returns>
+		virtual HRESULT STDMETHODCALLTYPE ResetSheet(
+		) = 0;
 };
 
 /// <summary>A glyph-atlas is a collection of glyph-sheets.</summary>
@@ -464,6 +552,30 @@ MIDL_INTERFACE("A31EB6A2-7458-4e24-82B3-945A95623B1F") IFW1GlyphAtlas : public I
 	virtual void STDMETHODCALLTYPE Flush(
 		__in ID3D11DeviceContext *pContext
 	) = 0;
+	
+	/// <summary>Stamp the glyphs in a set of vertices with the current frame.</summary>
+	/// <remarks>This is called by IFW1FontWrapper::DrawGeometry, so glyphs that are drawn are not evicted by IFW1GlyphAtlas::EvictGlyphs.<br/>
+	/// This method is not thread-safe.</remarks>
+	/// <returns>No return value.</returns>
+	/// <param name="pVertexData">Pointer to the vertices, sorted by sheet as returned by IFW1TextGeometry::GetGlyphVerticesTemp.</param>
+	virtual void STDMETHODCALLTYPE MarkGlyphsUsed(
+		__in const FW1_VERTEXDATA *pVertexData
+	) = 0;
+	
+	/// <summary>Reset sheets holding glyphs that have not been drawn recently, and advance the current frame.</summary>
+	/// <remarks>Sheets where no glyph has been drawn in the last <i>MaxIdleFrames</i> frames are reset once the atlas has failed to insert a glyph because it has run out of sheets.
+	/// Periodically, while at least three quarters of the sheets are in use or after an insert has recently failed, closed sheets where only a small part of the glyphs are still drawn are reset as well, so the glyphs still in use get packed into open sheets when they are next requested.<br/>
+	/// Atlas IDs of glyphs in reset sheets are no longer valid. This method is called by IFW1GlyphProvider::CollectGlyphs, which also invalidates its glyph-maps.<br/>
+	/// This method is not thread-safe.</remarks>
+	/// <returns>The number of sheets that were reset.</returns>
+	/// <param name="MaxIdleFrames">The number of frames a glyph can go without being drawn before it is considered unused.</param>
+	/// <param name="pEvictedSheets">Pointer to an array that receives TRUE for each sheet that was reset, and FALSE otherwise.</param>
+	/// <param name="SheetCount">The number of elements in the <i>pEvictedSheets</i> array.</param>
+	virtual UINT STDMETHODCALLTYPE EvictGlyphs(
+		__in UINT MaxIdleFrames,
+		__out BOOL *pEvictedSheets,
+		__in UINT SheetCount
+	) = 0;
 };
 
 /// <summary>Collection of glyph-maps, mapping font/size/glyph information to an ID in a glyph atlas.</summary>
@@ -524,13 +636,53 @@ MIDL_INTERFACE("F8360043-329D-4EC9-B0F8-ACB00FA77420") IFW1GlyphProvider : publi
 	/// Glyph indices can be obtained from DirectWrite using IDWriteFontFace::GetGlyphIndices.</param>
 	/// <param name="pFontFace">The DirectWrite font face that contains the glyph referenced by GlyphIndex.</param>
 	/// <param name="FontFlags">Can include zero or more of the following values, ORd together. Any additional values are ignored.<br/>
-	/// FW1_NONEWGLYPHS - No new glyphs are inserted.</param>
+	/// FW1_NONEWGLYPHS - No new glyphs are inserted.<br/>
+	/// FW1_ASYNCGLYPHS - New glyphs are rasterized on worker threads, and the font default-glyph is returned until IFW1GlyphProvider::InsertCompletedGlyphs inserts them.</param>
 	virtual UINT STDMETHODCALLTYPE GetAtlasIdFromGlyphIndex(
 		__in const void *pGlyphMap,
 		__in UINT16 GlyphIndex,
 		__in IDWriteFontFace *pFontFace,
 		__in UINT FontFlags
 	) = 0;
+	
+	/// <summary>Evict glyphs that have not been drawn recently from the glyph-atlas.</summary>
+	/// <remarks>Call once per frame, after drawing. See IFW1GlyphAtlas::EvictGlyphs.<br/>
+	/// Glyph-map entries for evicted glyphs, and glyphs that fell back to a default glyph, are cleared so they are inserted again on demand.
+	/// Atlas IDs obtained before the call should not be used if any sheets were reset.<br/>
+	/// This method must not be called while other threads request glyphs from the glyph-provider.</remarks>
+	/// <returns>The number of atlas sheets that were reset.</returns>
+	/// <param name="MaxIdleFrames">The number of frames a glyph can go without being drawn before it can be evicted.</param>
+	virtual UINT STDMETHODCALLTYPE CollectGlyphs(
+		__in UINT MaxIdleFrames
+	) = 0;
+	
+	/// <summary>Get the memory used by the glyph-provider.</summary>
+	/// <remarks>Glyph-maps only allocate pages for ranges of glyphs that have been requested, so fonts with many glyphs cost little when only a few are drawn.</remarks>
+	/// <returns>No return value.</returns>
+	/// <param name="pMemoryUsage">Pointer to a memory usage report.</param>
+	virtual void STDMETHODCALLTYPE GetMemoryUsage(
+		__out FW1_GLYPHPROVIDERMEMORYUSAGE *pMemoryUsage
+	) = 0;
+	
+	/// <summary>Insert glyphs rasterized on worker threads into the glyph-atlas.</summary>
+	/// <remarks>Glyphs requested with the FW1_ASYNCGLYPHS flag are rasterized in parallel on the system thread pool, and inserted into the atlas together by this method.
+	/// Until then, IFW1GlyphProvider::GetAtlasIdFromGlyphIndex returns the ID of the font's default glyph for them, so any geometry built in the meantime should be rebuilt if this method inserts any glyphs.</remarks>
+	/// <returns>The number of glyphs that were inserted, including glyphs that failed to rasterize and now use a fallback glyph.</returns>
+	virtual UINT STDMETHODCALLTYPE InsertCompletedGlyphs(
+	) = 0;
+	
+	/// <summary>Get the number of glyphs requested with FW1_ASYNCGLYPHS that have not yet been inserted into the glyph-atlas.</summary>
+	/// <remarks>This includes glyphs that are queued, being rasterized, or waiting for IFW1GlyphProvider::InsertCompletedGlyphs.</remarks>
+	/// <returns>The number of pending glyphs.</returns>
+	virtual UINT STDMETHODCALLTYPE GetPendingGlyphCount(
+	) = 0;
+	
+	/// <summary>Get the number of times IFW1GlyphProvider::GetAtlasIdFromGlyphIndex returned a placeholder for a glyph that was not yet inserted.</summary>
+	/// <remarks>The count only grows, so comparing it before and after building geometry tells if the geometry contains placeholders.
+	/// Only geometry with placeholders has to be rebuilt when IFW1GlyphProvider::InsertCompletedGlyphs inserts glyphs, as long as no glyphs were evicted.</remarks>
+	/// <returns>The number of placeholders returned so far.</returns>
+	virtual UINT STDMETHODCALLTYPE GetPlaceholderCount(
+	) = 0;
 };
 
 /// <summary>Container for a DirectWrite render-target, used to draw glyph images that are to be inserted in a glyph atlas.</summary>
@@ -658,6 +810,7 @@ MIDL_INTERFACE("51E05736-6AFF-44A8-9745-77605C99E8F2") IFW1TextRenderer : public
 	/// <param name="Flags">Can include zero or more of the following values, ORd together. Any additional values are ignored.<br/>
 	/// FW1_ALIASED - No anti-aliasing is used when drawing the glyphs.<br/>
 	/// FW1_NONEWGLYPHS - No new glyphs are inserted into the atlas. Not previously cached glyphs are replaced with a fallback glyph (usually an empty box).<br/>
+	/// FW1_ASYNCGLYPHS - New glyphs are rasterized on worker threads, and drawn as the font's fallback glyph until they are inserted by IFW1GlyphProvider::InsertCompletedGlyphs.<br/>
 	/// FW1_CACHEONLY - All glyphs are queried from the glyph-provider and cached in the glyph-atlas, but no geometry is produced.<br/>
 	/// FW1_ANALYZEONLY - The text-layout is analyzed and glyph-maps are prepared, but the glyphs in the string are not cached and no geometry is produced.<br/>
 	/// </param>
@@ -2,6 +2,572 @@
 
 #include "renderer.h"
 
+//
+// [public] draw list utilities
+//
+
+bool draw_list::is_supported_topology(D3D_PRIMITIVE_TOPOLOGY type)
+{
+	return type == D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST ||
+		type == D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP ||
+		type == D3D_PRIMITIVE_TOPOLOGY_LINELIST ||
+		type == D3D_PRIMITIVE_TOPOLOGY_LINESTRIP;
+}
+
+size_t draw_list::calc_vertex_count(size_t vertex_count, D3D_PRIMITIVE_TOPOLOGY type)
+{
+	switch (type)
+	{
+	case D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST:
+	case D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP:
+		return vertex_count;
+	// each line segment becomes a quad
+	case D3D_PRIMITIVE_TOPOLOGY_LINELIST:
+		return vertex_count / 2 * 4;
+	case D3D_PRIMITIVE_TOPOLOGY_LINESTRIP:
+		return vertex_count > 1 ? (vertex_count - 1) * 4 : 0;
+	default:
+		return 0;
+	}
+}
+
+size_t draw_list::calc_index_count(size_t vertex_count, D3D_PRIMITIVE_TOPOLOGY type)
+{
+	switch (type)
+	{
+	case D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST:
+		return vertex_count / 3 * 3;
+	case D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP:
+		return vertex_count > 2 ? (vertex_count - 2) * 3 : 0;
+	// each line segment becomes a quad made out of 2 triangles
+	case D3D_PRIMITIVE_TOPOLOGY_LINELIST:
+		return vertex_count / 2 * 6;
+	case D3D_PRIMITIVE_TOPOLOGY_LINESTRIP:
+		return vertex_count > 1 ? (vertex_count - 1) * 6 : 0;
+	default:
+		return 0;
+	}
+}
+
+template <typename Ty>
+std::span<Ty> draw_list::prim_reserve(size_t vertex_count, D3D_PRIMITIVE_TOPOLOGY type)
+{
+	finish_primitive();
+
+	auto& vertices = get_vertices<Ty>();
+	auto base = vertices.size();
+
+	// lines get expanded in place once they are finished, so reserve room for the quads as well
+	auto reserved_count = (std::max)(vertex_count, calc_vertex_count(vertex_count, type));
+	reserve_storage(vertices, base + reserved_count);
+	vertices.resize(base + reserved_count);
+
+	pending = { type, Ty::format, base, vertex_count };
+	primitive_count++;
+
+	return { vertices.data() + base, vertex_count };
+}
+
+template std::span<vertex> draw_list::prim_reserve<vertex>(size_t vertex_count, D3D_PRIMITIVE_TOPOLOGY type);
+template std::span<precise_vertex> draw_list::prim_reserve<precise_vertex>(size_t vertex_count, D3D_PRIMITIVE_TOPOLOGY type);
+
+void draw_list::push_clip_rect(const region& clip)
+{
+	// the pending primitive was recorded under the old clip rect
+	finish_primitive();
+
+	clip_stack.push_back(clip.intersect(get_clip_rect()));
+}
+
+void draw_list::pop_clip_rect()
+{
+	finish_primitive();
+
+	assert(!clip_stack.empty() && "pop_clip_rect - no clip rect was pushed");
+	if (!clip_stack.empty())
+		clip_stack.pop_back();
+}
+
+const region& draw_list::get_clip_rect() const
+{
+	return clip_stack.empty() ? viewport : clip_stack.back();
+}
+
+bool draw_list::is_clipped() const
+{
+	return !clip_stack.empty();
+}
+
+void draw_list::set_viewport(const region& new_viewport)
+{
+	viewport = new_viewport;
+}
+
+void draw_list::finish_primitive()
+{
+	if (pending.type == D3D_PRIMITIVE_TOPOLOGY_UNDEFINED)
+		return;
+
+	if (pending.format == vertex_format::precise)
+		build_indices<precise_vertex>();
+	else
+		build_indices<vertex>();
+
+	pending.type = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+}
+
+void draw_list::begin_capture()
+{
+	finish_primitive();
+
+	capture_start = { vertices.size(), precise_vertices.size(), indices.size(), batch_list.size(), batch_list.empty() ? 0 : batch_list.back().index_count,
+		glyphs.size(), glyph_batches.size(), glyph_batches.empty() ? 0 : glyph_batches.back().glyph_count, primitive_count, placeholder_run_count };
+	capturing = true;
+}
+
+void draw_list::end_capture(geometry_cache& cache)
+{
+	finish_primitive();
+
+	const auto& start = capture_start;
+	cache.vertices.assign(vertices.begin() + start.vertex_count, vertices.end());
+	cache.precise_vertices.assign(precise_vertices.begin() + start.precise_vertex_count, precise_vertices.end());
+	cache.glyphs.assign(glyphs.begin() + start.glyph_count, glyphs.end());
+	cache.indices.clear();
+	cache.batch_list.clear();
+	cache.primitive_count = primitive_count - start.primitive_count;
+
+	// the first captured indices may have been merged into the batch that was open when the capture started
+	auto index_pos = start.index_count;
+	for (auto i = start.batch_count == 0 ? 0 : start.batch_count - 1; i < batch_list.size(); ++i)
+	{
+		const auto& captured = batch_list[i];
+		auto index_count = i + 1 == start.batch_count ? captured.index_count - start.batch_index_count : captured.index_count;
+		if (index_count == 0)
+			continue;
+
+		// store indices relative to the capture, so they can be rebased onto wherever the cache gets added
+		auto base = static_cast<draw_index>(captured.format == vertex_format::precise ? start.precise_vertex_count : start.vertex_count);
+		for (auto j = 0u; j < index_count; ++j)
+			cache.indices.push_back(indices[index_pos + j] - base);
+
+		cache.batch_list.emplace_back(captured.format, captured.clip, index_count);
+		index_pos += index_count;
+	}
+
+	// glyphs get merged into the open glyph batch the same way
+	cache.glyph_batches.clear();
+	for (auto i = start.glyph_batch_count == 0 ? 0 : start.glyph_batch_count - 1; i < glyph_batches.size(); ++i)
+	{
+		const auto& captured = glyph_batches[i];
+		auto glyph_count = i + 1 == start.glyph_batch_count ? captured.glyph_count - start.glyph_batch_glyph_count : captured.glyph_count;
+		if (glyph_count > 0)
+			cache.glyph_batches.emplace_back(captured.clip, glyph_count);
+	}
+
+	cache.has_placeholder_glyphs = placeholder_run_count != start.placeholder_run_count;
+	capturing = false;
+}
+
+bool draw_list::is_capturing() const
+{
+	return capturing;
+}
+
+void draw_list::add_cached(const geometry_cache& cache)
+{
+	append(cache.vertices, cache.precise_vertices, cache.indices, cache.batch_list, cache.glyphs, cache.glyph_batches);
+	primitive_count += cache.primitive_count;
+
+	// a capture this gets added into has the placeholders as well
+	if (cache.has_placeholder_glyphs)
+		placeholder_run_count++;
+}
+
+void draw_list::splice(draw_list& other)
+{
+	other.finish_primitive();
+
+	// a draw list's indices start at its first vertex, so they get rebased like a geometry cache
+	append(other.vertices, other.precise_vertices, other.indices, other.batch_list, other.glyphs, other.glyph_batches);
+	primitive_count += other.primitive_count;
+	culled_count += other.culled_count;
+	placeholder_run_count += other.placeholder_run_count;
+	allocation_count += other.allocation_count;
+
+	other.clear();
+}
+
+//
+// [private] draw list helper functions
+//
+
+template <>
+std::vector<vertex>& draw_list::get_vertices<vertex>()
+{
+	return vertices;
+}
+
+template <>
+std::vector<precise_vertex>& draw_list::get_vertices<precise_vertex>()
+{
+	return precise_vertices;
+}
+
+template <typename Ty>
+void draw_list::reserve_storage(std::vector<Ty>& storage, size_t size)
+{
+	if (storage.capacity() >= size)
+		return;
+
+	// grow geometrically like push_back would
+	storage.reserve((std::max)(size, storage.capacity() * 2));
+	allocation_count++;
+}
+
+template <typename Ty>
+void draw_list::build_indices()
+{
+	auto& vertices = get_vertices<Ty>();
+	auto base = static_cast<draw_index>(pending.base);
+	auto vertex_count = pending.vertex_count;
+	auto index_count = calc_index_count(vertex_count, pending.type);
+
+	reserve_storage(indices, indices.size() + index_count);
+
+	switch (pending.type)
+	{
+	case D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST:
+	{
+		for (auto i = 0u; i < index_count; ++i)
+			indices.push_back(base + i);
+
+		break;
+	}
+	case D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP:
+	{
+		// every odd triangle in a strip has its winding flipped, keep the same winding the strip would have had
+		for (auto i = 0u; i + 2 < vertex_count; ++i)
+		{
+			if (i % 2 == 0)
+				indices.insert(indices.end(), { base + i, base + i + 1, base + i + 2 });
+			else
+				indices.insert(indices.end(), { base + i, base + i + 2, base + i + 1 });
+		}
+
+		break;
+	}
+	case D3D_PRIMITIVE_TOPOLOGY_LINELIST:
+	case D3D_PRIMITIVE_TOPOLOGY_LINESTRIP:
+	{
+		bool is_list = pending.type == D3D_PRIMITIVE_TOPOLOGY_LINELIST;
+		auto segments = calc_vertex_count(vertex_count, pending.type) / 4;
+
+		// expand back to front, quad n only overwrites points that belong to quads after it
+		for (auto n = segments; n-- > 0;)
+		{
+			auto first = is_list ? n * 2 : n;
+			set_line_quad(vertices, pending.base + n * 4, vertices[pending.base + first], vertices[pending.base + first + 1]);
+		}
+
+		vertices.resize(pending.base + segments * 4);
+
+		for (auto n = 0u; n < segments; ++n)
+		{
+			auto quad = base + n * 4;
+			indices.insert(indices.end(), { quad, quad + 1, quad + 2, quad, quad + 2, quad + 3 });
+		}
+
+		break;
+	}
+	default:
+		return;
+	}
+
+	add_indices(Ty::format, index_count);
+}
+
+template <typename Ty>
+void draw_list::set_line_quad(std::vector<Ty>& vertices, size_t index, Ty start, Ty end)
+{
+	// offset both ends by half the thickness along the line normal, this keeps the quad in clockwise order
+	float dx = end.x - start.x;
+	float dy = end.y - start.y;
+	float length = std::sqrt(dx * dx + dy * dy);
+	float scale = length > 0.f ? (line_thickness * 0.5f) / length : 0.f;
+	vec2 normal{ dy * scale, -dx * scale };
+
+	vertices[index] = start;
+	vertices[index] += normal;
+	vertices[index + 1] = end;
+	vertices[index + 1] += normal;
+	vertices[index + 2] = end;
+	vertices[index + 2] += normal * -1.f;
+	vertices[index + 3] = start;
+	vertices[index + 3] += normal * -1.f;
+}
+
+void draw_list::append(const std::vector<vertex>& other_vertices, const std::vector<precise_vertex>& other_precise_vertices, const std::vector<draw_index>& other_indices, const std::vector<batch>& other_batches, const std::vector<FW1_GLYPHVERTEX>& other_glyphs, const std::vector<glyph_batch>& other_glyph_batches)
+{
+	finish_primitive();
+
+	auto vertex_base = static_cast<draw_index>(vertices.size());
+	auto precise_vertex_base = static_cast<draw_index>(precise_vertices.size());
+
+	reserve_storage(vertices, vertices.size() + other_vertices.size());
+	vertices.insert(vertices.end(), other_vertices.begin(), other_vertices.end());
+
+	reserve_storage(precise_vertices, precise_vertices.size() + other_precise_vertices.size());
+	precise_vertices.insert(precise_vertices.end(), other_precise_vertices.begin(), other_precise_vertices.end());
+
+	reserve_storage(indices, indices.size() + other_indices.size());
+
+	size_t index_pos = 0;
+	for (const auto& other_batch : other_batches)
+	{
+		auto base = other_batch.format == vertex_format::precise ? precise_vertex_base : vertex_base;
+		for (auto j = 0u; j < other_batch.index_count; ++j)
+			indices.push_back(other_indices[index_pos + j] + base);
+
+		append_batch(other_batch.format, other_batch.clip, other_batch.index_count);
+		index_pos += other_batch.index_count;
+	}
+
+	reserve_storage(glyphs, glyphs.size() + other_glyphs.size());
+	glyphs.insert(glyphs.end(), other_glyphs.begin(), other_glyphs.end());
+
+	for (const auto& other_glyph_batch : other_glyph_batches)
+		append_glyph_batch(other_glyph_batch.clip, other_glyph_batch.glyph_count);
+}
+
+void draw_list::add_indices(vertex_format format, size_t index_count)
+{
+	append_batch(format, get_clip_rect(), index_count);
+}
+
+void draw_list::append_batch(vertex_format format, const region& clip, size_t index_count)
+{
+	// every primitive shares the same topology, so a batch only ends when the vertex format or clip rect changes
+	if (batch_list.empty() || batch_list.back().format != format || !(batch_list.back().clip == clip))
+	{
+		reserve_storage(batch_list, batch_list.size() + 1);
+		batch_list.emplace_back(format, clip, index_count);
+	}
+	else
+		batch_list.back().index_count += index_count;
+}
+
+void draw_list::append_glyph_batch(const region& clip, size_t glyph_count)
+{
+	if (glyph_count == 0)
+		return;
+
+	if (glyph_batches.empty() || !(glyph_batches.back().clip == clip))
+	{
+		reserve_storage(glyph_batches, glyph_batches.size() + 1);
+		glyph_batches.emplace_back(clip, glyph_count);
+	}
+	else
+		glyph_batches.back().glyph_count += glyph_count;
+}
+
+//
+// [public] ring buffer utilities
+//
+
+ring_buffer::ring_buffer(UINT bind_flags, size_t element_size, size_t capacity) :
+	p_buffer(nullptr),
+	bind_flags(bind_flags),
+	element_size(element_size),
+	capacity(capacity),
+	position(capacity) // start full so the first upload discards
+{ }
+
+ring_buffer::~ring_buffer()
+{
+	safe_release(p_buffer);
+}
+
+HRESULT ring_buffer::create(ID3D11Device* p_device)
+{
+	safe_release(p_buffer);
+	p_buffer = nullptr;
+
+	D3D11_BUFFER_DESC bd;
+	ZeroMemory(&bd, sizeof(bd));
+
+	bd.Usage = D3D11_USAGE_DYNAMIC;								 // write access access by CPU and GPU
+	bd.ByteWidth = static_cast<UINT>(element_size * capacity);	 // size is the element size * capacity
+	bd.BindFlags = bind_flags;									 // vertex or index buffer
+	bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;					 // allow CPU to write in buffer
+
+	// a new buffer has nothing in flight, but discard on its first map anyway
+	position = capacity;
+
+	return p_device->CreateBuffer(&bd, NULL, &p_buffer);
+}
+
+HRESULT ring_buffer::upload(ID3D11Device* p_device, ID3D11DeviceContext* p_device_context, const void* p_data, size_t count, size_t& offset)
+{
+	auto map_type = D3D11_MAP_WRITE_NO_OVERWRITE;
+
+	if (count > capacity)
+	{
+		// grow to the next power of two that holds the whole upload
+		while (capacity < count)
+			capacity *= 2;
+
+		HRESULT hr = create(p_device);
+		if (FAILED(hr))
+			return hr;
+	}
+
+	// only discard when we wrap, everything before position might still be read by the gpu
+	if (position + count > capacity)
+	{
+		map_type = D3D11_MAP_WRITE_DISCARD;
+		position = 0;
+	}
+
+	D3D11_MAPPED_SUBRESOURCE mapped_resource;
+	HRESULT hr = p_device_context->Map(p_buffer, NULL, map_type, NULL, &mapped_resource);
+	if (FAILED(hr))
+		return hr;
+
+	memcpy(static_cast<uint8_t*>(mapped_resource.pData) + position * element_size, p_data, count * element_size);
+	p_device_context->Unmap(p_buffer, NULL);
+
+	offset = position;
+	position += count;
+
+	return S_OK;
+}
+
+ID3D11Buffer* ring_buffer::get() const
+{
+	return p_buffer;
+}
+
+size_t ring_buffer::get_capacity() const
+{
+	return capacity;
+}
+
+//
+// [public] text layout cache utilities
+//
+
+bool text_layout_cache::key::operator==(const key& other) const
+{
+	return text == other.text && font_index == other.font_index && flags == other.flags && rect_size == other.rect_size && origin_fraction == other.origin_fraction;
+}
+
+size_t text_layout_cache::key_hash::operator()(const key& layout_key) const
+{
+	auto hash = std::hash<std::wstring_view>{}(layout_key.text);
+
+	auto combine = [&hash](size_t value) { hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2); };
+	combine(std::hash<uint32_t>{}(layout_key.font_index));
+	combine(std::hash<uint32_t>{}(layout_key.flags));
+	combine(std::hash<float>{}(layout_key.rect_size.x));
+	combine(std::hash<float>{}(layout_key.rect_size.y));
+	combine(std::hash<float>{}(layout_key.origin_fraction.x));
+	combine(std::hash<float>{}(layout_key.origin_fraction.y));
+
+	return hash;
+}
+
+text_layout_cache::text_layout_cache(size_t memory_cap) :
+	entries(),
+	lookup(),
+	memory_cap(memory_cap),
+	memory_used(0),
+	hit_count(0),
+	miss_count(0),
+	eviction_count(0)
+{ }
+
+glyph_run_ptr text_layout_cache::find(const key& layout_key)
+{
+	auto it = lookup.find(layout_key);
+	if (it == lookup.end())
+	{
+		miss_count++;
+		return nullptr;
+	}
+
+	hit_count++;
+	entries.splice(entries.begin(), entries, it->second);
+	return it->second->glyphs;
+}
+
+glyph_run_ptr text_layout_cache::insert(const key& layout_key, glyph_run&& run)
+{
+	run.glyphs.shrink_to_fit();
+
+	// the map node and the text are counted along with the glyphs
+	auto memory = sizeof(entry) + sizeof(decltype(lookup)::value_type) + sizeof(void*) * 2 +
+		layout_key.text.size() * sizeof(wchar_t) + run.glyphs.size() * sizeof(FW1_GLYPHVERTEX);
+
+	evict(memory);
+
+	auto& new_entry = entries.emplace_front(entry{ std::wstring(layout_key.text), layout_key, std::make_shared<const glyph_run>(std::move(run)), memory });
+	new_entry.layout_key.text = new_entry.text;
+
+	lookup.emplace(new_entry.layout_key, entries.begin());
+	memory_used += memory;
+
+	return new_entry.glyphs;
+}
+
+void text_layout_cache::clear()
+{
+	lookup.clear();
+	entries.clear();
+	memory_used = 0;
+}
+
+void text_layout_cache::evict_placeholder_runs()
+{
+	for (auto it = entries.begin(); it != entries.end();)
+	{
+		if (!it->glyphs->has_placeholders)
+		{
+			++it;
+			continue;
+		}
+
+		memory_used -= it->memory;
+		lookup.erase(it->layout_key);
+		it = entries.erase(it);
+		eviction_count++;
+	}
+}
+
+void text_layout_cache::set_memory_cap(size_t new_memory_cap)
+{
+	memory_cap = new_memory_cap;
+	evict(0);
+}
+
+text_cache_stats text_layout_cache::get_stats() const
+{
+	return { hit_count, miss_count, eviction_count, entries.size(), memory_used, memory_cap };
+}
+
+void text_layout_cache::evict(size_t reserve)
+{
+	// a single run bigger than the cap still gets cached so the caller can use it, it is the first to go on the next insert
+	while (!entries.empty() && memory_used + reserve > memory_cap)
+	{
+		auto& oldest = entries.back();
+		memory_used -= oldest.memory;
+		lookup.erase(oldest.layout_key);
+		entries.pop_back();
+		eviction_count++;
+	}
+}
+
 //
 // [public] renderer utilities
 //
@@ -15,9 +581,10 @@ void renderer::initialize(HWND hwnd, const color& render_target_color, const std
 	setup_shaders();
 	setup_input_layout();
 	setup_vertex_buffer();
+	setup_index_buffer();
 	setup_blend_state();
 	//setup_depth_stencil_state();
-	//setup_rasterizer_state();
+	setup_rasterizer_state();
 	setup_font_renderer(font);
 	setup_screen_projection();
 	setup_font_renderer(font);
@@ -31,41 +598,136 @@ void renderer::draw()
 	if (!initialized)
 		handle_error("draw - renderer is not initialized, did you call initialize()?");
 
+	// nothing changed, the swapchain still shows the last presented frame
+	if (!needs_redraw())
+	{
+		default_draw_list.clear();
+		idle_frame_count++;
+		return;
+	}
+
 	p_device_context->ClearRenderTargetView(p_backbuffer, &render_target_color.r);
 
-	// only draw draw list vertices if size > 0
-	if (default_draw_list.vertices.size())
-	{
-		// map our vertex buffer 
-		D3D11_MAPPED_SUBRESOURCE mapped_resource;
-		if (FAILED(p_device_context->Map(p_vertex_buffer, NULL, D3D11_MAP_WRITE_DISCARD, NULL, &mapped_resource)))
-			return;
+	// build the indices of the last primitive that was reserved
+	default_draw_list.finish_primitive();
 
-		// copy our vertex buffer and unmap
-		memcpy(mapped_resource.pData, default_draw_list.vertices.data(), default_draw_list.vertices.size() * sizeof(vertex));
-		p_device_context->Unmap(p_vertex_buffer, NULL);
+	// only draw draw list vertices if there are indices to draw
+	if (default_draw_list.indices.size())
+		submit_draw_list();
 
-		// iterate each batch and draw it with the respective primitive type
-		size_t buffer_index = 0;
-		for (auto& batch : default_draw_list.batch_list)
-		{
-			p_device_context->IASetPrimitiveTopology(batch.type);
-			p_device_context->Draw(static_cast<UINT>(batch.vertex_count), static_cast<UINT>(buffer_index));
-			buffer_index += batch.vertex_count;
-		}
-	}
-	
 	p_font_wrapper->Flush(p_device_context);
-	p_font_wrapper->DrawGeometry(p_device_context, default_draw_list.p_text_geometry, nullptr, nullptr, FW1_RESTORESTATE);
+	submit_glyphs();
 
+	last_frame_stats = default_draw_list.get_stats();
 	default_draw_list.clear();
 
 	p_swapchain->Present(1, 0);
+
+	frame_dirty = false;
+	last_present_time = std::chrono::steady_clock::now();
+
+	// glyphs rasterized in the background replace their placeholders, only runs and captured geometry with placeholders have to be built again
+	auto inserted_glyphs = p_glyph_provider->InsertCompletedGlyphs();
+
+	// glyphs not drawn for a while get evicted from the atlas, any cached run or captured geometry may reference their old atlas ids
+	auto evicted_sheets = p_glyph_provider->CollectGlyphs(GLYPH_EVICTION_IDLE_FRAMES);
+
+	if (evicted_sheets > 0)
+	{
+		std::lock_guard lock{ text_mutex };
+		text_cache.clear();
+		geometry_generation++;
+		frame_dirty = true;
+	}
+	else if (inserted_glyphs > 0)
+	{
+		std::lock_guard lock{ text_mutex };
+		text_cache.evict_placeholder_runs();
+		placeholder_generation++;
+		frame_dirty = true;
+	}
+}
+
+void renderer::mark_dirty()
+{
+	frame_dirty = true;
+}
+
+bool renderer::needs_redraw() const
+{
+	if (frame_dirty || max_idle_interval <= 0.f)
+		return true;
+
+	// keep presenting until glyphs rasterized in the background have replaced their placeholders
+	if (p_glyph_provider && p_glyph_provider->GetPendingGlyphCount() > 0)
+		return true;
+
+	return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - last_present_time).count() >= max_idle_interval;
+}
+
+void renderer::set_max_idle_interval(float milliseconds)
+{
+	max_idle_interval = milliseconds;
+}
+
+void renderer::set_async_glyphs(bool enabled)
+{
+	async_glyphs = enabled;
+}
+
+size_t renderer::get_idle_frame_count() const
+{
+	return idle_frame_count;
+}
+
+void renderer::begin_geometry_capture()
+{
+	if (get_draw_list().is_capturing())
+		handle_error("begin_geometry_capture - a capture is already in progress");
+
+	get_draw_list().begin_capture();
+}
+
+void renderer::end_geometry_capture(geometry_cache& cache)
+{
+	if (!get_draw_list().is_capturing())
+		handle_error("end_geometry_capture - begin_geometry_capture() was not called");
+
+	get_draw_list().end_capture(cache);
+	cache.generation = geometry_generation;
+	cache.placeholder_generation = placeholder_generation;
+}
+
+void renderer::set_thread_draw_list(draw_list* p_list)
+{
+	// thread draw lists clip against the same viewport as the frame's draw list
+	if (p_list)
+		p_list->set_viewport(default_draw_list.viewport);
+
+	p_thread_draw_list = p_list;
+}
+
+void renderer::splice_draw_list(draw_list& list)
+{
+	default_draw_list.splice(list);
+}
+
+bool renderer::add_geometry(const geometry_cache& cache)
+{
+	if (cache.generation != geometry_generation)
+		return false;
+
+	if (cache.has_placeholder_glyphs && cache.placeholder_generation != placeholder_generation)
+		return false;
+
+	get_draw_list().add_cached(cache);
+	return true;
 }
 
 void renderer::set_render_target_color(const color& new_color)
 {
 	render_target_color = new_color;
+	frame_dirty = true;
 }
 
 void renderer::cleanup()
@@ -81,73 +743,105 @@ void renderer::cleanup()
 
 void renderer::add_line(const vec2& start, const vec2& end, const color& color)
 {
-	vertex vertices[] =
-	{
-		vertex{start, color },
-		vertex{end,   color },
-	};
-
-	add_vertices(vertices, sizeof(vertices) / sizeof(vertex), D3D_PRIMITIVE_TOPOLOGY_LINELIST);
+	auto vertices = prim_reserve(2, D3D_PRIMITIVE_TOPOLOGY_LINELIST);
+	vertices[0] = { start, color };
+	vertices[1] = { end,   color };
 }
 
 void renderer::add_polyline(const vec2* points, size_t size, const color& color)
 {
-	std::vector<vertex> vertices;
+	auto vertices = prim_reserve(size, D3D_PRIMITIVE_TOPOLOGY_LINESTRIP);
 	
 	for (auto i = 0u; i < size; ++i)
-		vertices.emplace_back(points[i], color);
-
-	add_vertices(vertices.data(), vertices.size(), D3D_PRIMITIVE_TOPOLOGY_LINESTRIP);
+		vertices[i] = { points[i], color };
 }
 
-void renderer::add_line_multicolor(const vec2& start, const vec2& end, const color& start_color, const color& end_color)
+void renderer::add_line_multicolor(const vec2& start, const vec2& end, const color& start_color, const color& end_color, bool precise_colors)
 {
-	vertex vertices[] =
+	if (precise_colors)
 	{
-		{start, start_color },
-		{end,   end_color   }
-	};
+		auto vertices = prim_reserve<precise_vertex>(2, D3D_PRIMITIVE_TOPOLOGY_LINELIST);
+		vertices[0] = { start, start_color };
+		vertices[1] = { end,   end_color   };
+		return;
+	}
 
-	add_vertices(vertices, sizeof(vertices) / sizeof(vertex), D3D_PRIMITIVE_TOPOLOGY_LINELIST);
+	auto vertices = prim_reserve(2, D3D_PRIMITIVE_TOPOLOGY_LINELIST);
+	vertices[0] = { start, start_color };
+	vertices[1] = { end,   end_color   };
 }
 
 void renderer::add_rect_filled(const vec2& top_left, const vec2& size, const color& color)
 {
-	vertex vertices[] = 
-	{
-		{ top_left,                                       color },//{ -0.5f, 0.5f, 0.0f, red },   // top left
-		{ vec2{top_left.x + size.x, top_left.y},		  color }, // top right
-		{ vec2{top_left.x, top_left.y + size.y},          color },  // bottom_left
-		{ vec2{top_left.x + size.x, top_left.y + size.y}, color }, // bottom_right
-	};
+	vec2 clipped_top_left = top_left;
+	vec2 clipped_size = size;
+
+	if (!clip_rect(clipped_top_left, clipped_size))
+		return;
 
-	add_vertices(vertices, sizeof(vertices) / sizeof(vertex), D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+	auto vertices = prim_reserve(4, D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+	vertices[0] = { clipped_top_left,                                                  color }; // top left
+	vertices[1] = { {clipped_top_left.x + clipped_size.x, clipped_top_left.y},         color }; // top right
+	vertices[2] = { {clipped_top_left.x, clipped_top_left.y + clipped_size.y},         color }; // bottom_left
+	vertices[3] = { clipped_top_left + clipped_size,                                   color }; // bottom_right
 }
 
-void renderer::add_rect_filled_multicolor(const vec2& top_left, const vec2& size, const color& top_left_color, const color& top_right_color, const color& bottom_left_color, const color& bottom_right_color)
+void renderer::add_rect_filled_multicolor(const vec2& top_left, const vec2& size, const color& top_left_color, const color& top_right_color, const color& bottom_left_color, const color& bottom_right_color, bool precise_colors)
 {
-	vertex vertices[] =
+	vec2 clipped_top_left = top_left;
+	vec2 clipped_size = size;
+
+	if (!clip_rect(clipped_top_left, clipped_size))
+		return;
+
+	// a trimmed rect needs the gradient colors at its new corners
+	auto color_at = [&](const vec2& pos) -> color
 	{
-		{ top_left,                                       top_left_color},//{ -0.5f, 0.5f, 0.0f, red },   // top left
-		{ {top_left.x + size.x, top_left.y},			  top_right_color }, // top right
-		{ {top_left.x, top_left.y + size.y},          bottom_left_color },  // bottom_left
-		{ {top_left.x + size.x, top_left.y + size.y}, bottom_right_color }, // bottom_right
+		float u = size.x != 0.f ? (pos.x - top_left.x) / size.x : 0.f;
+		float v = size.y != 0.f ? (pos.y - top_left.y) / size.y : 0.f;
+
+		return top_left_color.lerp(top_right_color, u).lerp(bottom_left_color.lerp(bottom_right_color, u), v);
 	};
 
-	add_vertices(vertices, sizeof(vertices) / sizeof(vertex), D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
-}
+	vec2 corners[] =
+	{
+		clipped_top_left,												// top left
+		{ clipped_top_left.x + clipped_size.x, clipped_top_left.y },	// top right
+		{ clipped_top_left.x, clipped_top_left.y + clipped_size.y },	// bottom_left
+		clipped_top_left + clipped_size,								// bottom_right
+	};
 
-void renderer::add_triangle(const vec2& p1, const vec2& p2, const vec2& p3, const color& color)
-{
-	vertex vertices[] =
+	bool trimmed = !(clipped_top_left == top_left && clipped_size == size);
+
+	color corner_colors[] =
 	{
-		{ p1,  color},
-		{ p2,  color},
-		{ p3,  color},
-		{ p1,  color},
+		trimmed ? color_at(corners[0]) : top_left_color,
+		trimmed ? color_at(corners[1]) : top_right_color,
+		trimmed ? color_at(corners[2]) : bottom_left_color,
+		trimmed ? color_at(corners[3]) : bottom_right_color,
 	};
 
-	add_vertices(vertices, sizeof(vertices) / sizeof(vertex), D3D_PRIMITIVE_TOPOLOGY_LINESTRIP);
+	if (precise_colors)
+	{
+		auto vertices = prim_reserve<precise_vertex>(4, D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+		for (auto i = 0u; i < 4; ++i)
+			vertices[i] = { corners[i], corner_colors[i] };
+
+		return;
+	}
+
+	auto vertices = prim_reserve(4, D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+	for (auto i = 0u; i < 4; ++i)
+		vertices[i] = { corners[i], corner_colors[i] };
+}
+
+void renderer::add_triangle(const vec2& p1, const vec2& p2, const vec2& p3, const color& color)
+{
+	auto vertices = prim_reserve(4, D3D_PRIMITIVE_TOPOLOGY_LINESTRIP);
+	vertices[0] = { p1, color };
+	vertices[1] = { p2, color };
+	vertices[2] = { p3, color };
+	vertices[3] = { p1, color };
 }
 
 void renderer::add_triangle_filled(const vec2& p1, const vec2& p2, const vec2& p3, const color& color)
@@ -205,17 +899,13 @@ void renderer::add_triangle_filled(const vec2& p1, const vec2& p2, const vec2& p
 		}
 	}
 
-	vertex vertices[] =
-	{
-		{ first,  color},
-		{ second, color},
-		{ third,  color},
-	};
-
-	add_vertices(vertices, sizeof(vertices) / sizeof(vertex), D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	auto vertices = prim_reserve(3, D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	vertices[0] = { first,  color };
+	vertices[1] = { second, color };
+	vertices[2] = { third,  color };
 }
 
-void renderer::add_triangle_filled_multicolor(const vec2& p1, const vec2& p2, const vec2& p3, const color& p1_color, const color& p2_color, const color& p3_color)
+void renderer::add_triangle_filled_multicolor(const vec2& p1, const vec2& p2, const vec2& p3, const color& p1_color, const color& p2_color, const color& p3_color, bool precise_colors)
 {
 	// need to arrange filled triangles in clockwise order
 	vec2 first{};
@@ -270,139 +960,102 @@ void renderer::add_triangle_filled_multicolor(const vec2& p1, const vec2& p2, co
 		}
 	}
 
-	vertex vertices[] =
+	if (precise_colors)
 	{
-		{ first,  p1_color},
-		{ second, p2_color},
-		{ third,  p3_color},
-	};
+		auto vertices = prim_reserve<precise_vertex>(3, D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		vertices[0] = { first,  p1_color };
+		vertices[1] = { second, p2_color };
+		vertices[2] = { third,  p3_color };
+		return;
+	}
 
-	add_vertices(vertices, sizeof(vertices) / sizeof(vertex), D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	auto vertices = prim_reserve(3, D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	vertices[0] = { first,  p1_color };
+	vertices[1] = { second, p2_color };
+	vertices[2] = { third,  p3_color };
 }
 
 void renderer::add_circle(const vec2& middle, float radius, const color& color, size_t segments)
 {
-	// segment count must be between 4 and MAX_DRAW_LIST_VERTICES
-	if (segments < 4 || segments > MAX_DRAW_LIST_VERTICES - 1)
-		handle_error("add_circle - need at least 4 and less than MAX_DRAW_LIST_VERTICES");
+	segments = resolve_circle_segments(radius, segments);
 
-	// store unit circle locations for circle resolutions(segments) to avoid calculating each add
-	static std::unordered_map<size_t, std::vector<vec2>> positions_cache{};
+	// segment count must be between 4 and MAX_CIRCLE_SEGMENTS
+	if (segments < 4 || segments > MAX_CIRCLE_SEGMENTS - 1)
+		handle_error("add_circle - need at least 4 and less than MAX_CIRCLE_SEGMENTS");
 
-	std::vector<vec2> positions{};
-
-	auto cached_positions = positions_cache.find(segments);
-
-	if (cached_positions == positions_cache.end())
-	{
-		for (auto i = 0u; i <= segments; ++i)
-		{
-			float theta = calc_theta(i, segments);
-			positions.emplace_back( cos(theta), sin(theta));
-		}
+	if (!is_visible({ middle - radius, vec2{ radius * 2.f } }))
+		return;
 
-		positions_cache[segments] = positions;
-	}
+	const auto& table = get_circle_table(segments, false);
+	auto vertices = prim_reserve(table.x.size(), D3D_PRIMITIVE_TOPOLOGY_LINESTRIP);
 
-	else
-		positions = cached_positions->second;
-	
-	// might be a good idea to cache these later on
-	std::vector<vertex> vertices{};
-
-	for (auto& position : positions)
-		vertices.emplace_back(vec2{ position.x * radius + middle.x, position.y * radius + middle.y }, color);
-	
-	add_vertices(vertices.data(), vertices.size(), D3D_PRIMITIVE_TOPOLOGY_LINESTRIP);
+	transform_unit_circle(table.x.data(), table.y.data(), table.x.size(), middle, radius, 1.f, 0.f, color.to_hex_abgr(), vertices.data());
 }
 
 void renderer::add_clipped_circle(const region& region, const vec2& middle, float radius, const color& color, size_t segments)
 {
-	// segment count must be between 4 and MAX_DRAW_LIST_VERTICES
-	if (segments < 4 || segments > MAX_DRAW_LIST_VERTICES - 1)
-		handle_error("add_circle - need at least 4 and less than MAX_DRAW_LIST_VERTICES");
-
-	// store unit circle locations for circle resolutions(segments) to avoid calculating each add
-	static std::unordered_map<size_t, std::vector<vec2>> positions_cache{};
-
-	std::vector<vec2> positions{};
-
-	auto cached_positions = positions_cache.find(segments);
-
-	if (cached_positions == positions_cache.end())
-	{
-		for (auto i = 0u; i <= segments; ++i)
-		{
-			float theta = calc_theta(i, segments);
-			positions.emplace_back(cos(theta), sin(theta));
-		}
-
-		positions_cache[segments] = positions;
-	}
+	push_clip_rect(region.top_left, region.size);
+	add_circle(middle, radius, color, segments);
+	pop_clip_rect();
+}
 
-	else
-		positions = cached_positions->second;
+void renderer::add_circle_filled(const vec2& middle, float radius, const color& color, size_t segments)
+{
+	segments = resolve_circle_segments(radius, segments);
 
-	// might be a good idea to cache these later on
-	std::vector<vertex> vertices{};
+	// segment count must be between 4 and MAX_CIRCLE_SEGMENTS
+	if (segments < 4 || segments > MAX_CIRCLE_SEGMENTS - 1)
+		handle_error("add_circle_filled - need at least 4 and less than MAX_CIRCLE_SEGMENTS");
 
-	for (auto& position : positions)
-	{
-		vec2 abs{ position.x * radius + middle.x, position.y * radius + middle.y };
+	if (!is_visible({ middle - radius, vec2{ radius * 2.f } }))
+		return;
 
-		vertices.emplace_back(abs, region.is_within(abs) ? color : colors::clear);
-	}
+	const auto& table = get_circle_table(segments, true);
+	auto vertices = prim_reserve(table.x.size(), D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
 
-	add_vertices(vertices.data(), vertices.size(), D3D_PRIMITIVE_TOPOLOGY_LINESTRIP);
+	transform_unit_circle(table.x.data(), table.y.data(), table.x.size(), middle, radius, 1.f, 0.f, color.to_hex_abgr(), vertices.data());
 }
 
-void renderer::add_circle_filled(const vec2& middle, float radius, const color& color, size_t segments)
+void renderer::add_arc(const vec2& middle, float radius, float start_angle, float end_angle, const color& color, size_t segments)
 {
-	// segment count must be between 4 and MAX_DRAW_LIST_VERTICES
-	if (segments < 4 || segments > MAX_DRAW_LIST_VERTICES - 1)
-		handle_error("add_circle_filled - need at least 4 and less than MAX_DRAW_LIST_VERTICES");
+	segments = resolve_circle_segments(radius, segments);
 
-	// for each circle resolution(segments), we only need to calculate the vertex locations once to avoid calling calc_theta(), sin(), and cos() every call
-	static std::unordered_map<size_t, std::vector<vec2>> positions_cache{};
+	// segment count must be between 4 and MAX_CIRCLE_SEGMENTS
+	if (segments < 4 || segments > MAX_CIRCLE_SEGMENTS - 1)
+		handle_error("add_arc - need at least 4 and less than MAX_CIRCLE_SEGMENTS");
 
-	// declare our vertex list, these will be unit circle coords, multiply by radius and account for middle position to get correct size
-	std::vector<vec2> positions{};
+	if (!is_visible({ middle - radius, vec2{ radius * 2.f } }))
+		return;
 
-	// check for cached vertices
-	auto cached_positions = positions_cache.find(segments);
+	if (end_angle < start_angle)
+		std::swap(start_angle, end_angle);
 
-	// if we do not have this circle resolution cached, we need to add it
-	if (cached_positions == positions_cache.end())
-	{
-		// vertices 1, 2 and 3 need to be added first
-		auto theta_1 = calc_theta(0, segments);
-		auto theta_2 = calc_theta(1, segments);
-		auto theta_3 = calc_theta(segments - 1, segments);
-		
-		positions.emplace_back(cos(theta_1), sin(theta_1));
-		positions.emplace_back(cos(theta_2), sin(theta_2));
-		positions.emplace_back(cos(theta_3), sin(theta_3));
+	float sweep = (std::min)(end_angle - start_angle, 2.f * PI);
+	if (sweep <= 0.f)
+		return;
 
-		// for the 4th, 5th, ... nth vertex, its position is dependant on its nth number becuase of trianglestrips
-		for (auto list_place = 4u; list_place <= segments; ++list_place)
-		{
-			// calculate where on the circle the vertex needs to calculated from vertex order for 8 segments the clockwise order is goes 1,2,4,6,8,7,5,3
-			auto vertex_n = list_place % 2 != 0 ? segments - list_place / 2 : list_place / 2;
-			auto theta_n = calc_theta(vertex_n, segments);
-			positions.emplace_back(cos(theta_n), sin(theta_n));
-		}
+	// walk whole steps of the full circle table rotated to start_angle, then end exactly on end_angle
+	const auto& table = get_circle_table(segments, false);
+	auto steps = (std::min)(static_cast<size_t>(sweep / (2.f * PI) * segments), segments);
+	auto vertices = prim_reserve(steps + 2, D3D_PRIMITIVE_TOPOLOGY_LINESTRIP);
 
-		positions_cache[segments] = positions;
-	}
-	else
-		positions = cached_positions->second;
+	transform_unit_circle(table.x.data(), table.y.data(), steps + 1, middle, radius, std::cos(start_angle), std::sin(start_angle), color.to_hex_abgr(), vertices.data());
+	vertices[steps + 1] = { vec2{ middle.x + std::cos(start_angle + sweep) * radius, middle.y + std::sin(start_angle + sweep) * radius }, color };
+}
 
-	std::vector<vertex> vertices{};
+void renderer::set_circle_max_error(float max_error)
+{
+	circle_max_error = max_error;
+}
 
-	for (auto& position : positions)
-		vertices.emplace_back(vec2{ position.x * radius + middle.x, position.y * radius + middle.y }, color);
+void renderer::push_clip_rect(const vec2& top_left, const vec2& size)
+{
+	get_draw_list().push_clip_rect({ top_left, size });
+}
 
-	add_vertices(vertices.data(), vertices.size(), D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+void renderer::pop_clip_rect()
+{
+	get_draw_list().pop_clip_rect();
 }
 
 // 
@@ -410,6 +1063,11 @@ void renderer::add_circle_filled(const vec2& middle, float radius, const color&
 //
 
 void renderer::add_text(const vec2& top_left, const vec2& size, const std::wstring& text, const color& color, float font_size, text_align text_flags)
+{
+	add_text(top_left, size, text, color, get_font(font_size), text_flags);
+}
+
+void renderer::add_text(const vec2& top_left, const vec2& size, const std::wstring& text, const color& color, font_handle text_font, text_align text_flags)
 {
 	if (text.empty())
 		return;
@@ -417,10 +1075,15 @@ void renderer::add_text(const vec2& top_left, const vec2& size, const std::wstri
 	auto final_flags = static_cast<uint32_t>(text_flags) | FW1_NOFLUSH | FW1_NOWORDWRAP;
 
 	FW1_RECTF rect{ top_left.x, top_left.y, top_left.x + size.x, top_left.y + size.y };
-	p_font_wrapper->AnalyzeString(nullptr, text.c_str(), L"Consolas", font_size, &rect, color.to_hex_abgr(), final_flags, default_draw_list.p_text_geometry);
+	analyze_text(text, text_font, rect, color.to_hex_abgr(), final_flags);
 }
 
 void renderer::add_text_with_bg(const vec2& top_left, const vec2& size, const std::wstring& text, const color& text_color, const color& bg_color, float font_size, text_align text_flags)
+{
+	add_text_with_bg(top_left, size, text, text_color, bg_color, get_font(font_size), text_flags);
+}
+
+void renderer::add_text_with_bg(const vec2& top_left, const vec2& size, const std::wstring& text, const color& text_color, const color& bg_color, font_handle text_font, text_align text_flags)
 {
 	if (text.empty())
 		return;
@@ -432,56 +1095,66 @@ void renderer::add_text_with_bg(const vec2& top_left, const vec2& size, const st
 
 	// rect for drawing background behind text
 	FW1_RECTF text_box_rect{ top_left.x, top_left.y, top_left.x, top_left.y };
-	FW1_RECTF text_box = p_font_wrapper->MeasureString(text.c_str(), L"Consolas", font_size, &text_box_rect, final_flags);
+	FW1_RECTF text_box = measure_string(text, text_font, text_box_rect, final_flags);
 
 	add_rect_filled({text_box.Left - 1.f, text_box.Top}, { text_box.Right - text_box.Left + 1.f, text_box.Bottom - text_box.Top }, bg_color);
 
-	p_font_wrapper->AnalyzeString(nullptr, text.c_str(), L"Consolas", font_size, &rect, text_color.to_hex_abgr(), final_flags, default_draw_list.p_text_geometry);
+	analyze_text(text, text_font, rect, text_color.to_hex_abgr(), final_flags);
 }
 
 void renderer::add_outlined_text(const vec2& top_left, const vec2& size, const std::wstring& text, const color& text_color, const color& outline_color, float font_size, float outline_size, text_align flags)
 {
+	add_outlined_text(top_left, size, text, text_color, outline_color, get_font(font_size), outline_size, flags);
+}
+
+void renderer::add_outlined_text(const vec2& top_left, const vec2& size, const std::wstring& text, const color& text_color, const color& outline_color, font_handle text_font, float outline_size, text_align flags)
+{
+	if (text.empty())
+		return;
+
+	auto final_flags = static_cast<uint32_t>(flags) | FW1_NOFLUSH | FW1_NOWORDWRAP;
+
+	// the text only gets laid out once, the outline is the same glyph run stamped around it
+	FW1_RECTF rect{ top_left.x, top_left.y, top_left.x + size.x, top_left.y + size.y };
+	auto p_glyphs = get_text_layout(text, text_font, rect, final_flags);
+	const auto& run = *p_glyphs;
+
+	vec2 origin{ std::floor(rect.Left), std::floor(rect.Top) };
+
 	// add shadows
-	// -1,-1
-	add_text(top_left - outline_size, size, text, outline_color, font_size, flags);
-	// 0, -1
-	add_text({ top_left.x, top_left.y - outline_size }, size, text, outline_color, font_size, flags);
-	// 1, -1
-	add_text({ top_left.x + outline_size, top_left.y - outline_size }, size, text, outline_color, font_size, flags);
-	// 1, 0
-	add_text({ top_left.x + outline_size, top_left.y }, size, text, outline_color, font_size, flags);
-	// 1, 1
-	add_text(top_left + outline_size, size, text, outline_color, font_size, flags);
-	// 0, 1
-	add_text({ top_left.x, top_left.y + outline_size }, size, text, outline_color, font_size, flags);
-	// -1, 1
-	add_text({ top_left.x - outline_size, top_left.y + outline_size }, size, text, outline_color, font_size, flags);
-	// -1, 0
-	add_text({ top_left.x - outline_size, top_left.y }, size, text, outline_color, font_size, flags);
+	vec2 offsets[] =
+	{
+		{ -1.f, -1.f }, { 0.f, -1.f }, { 1.f, -1.f }, { 1.f, 0.f },
+		{ 1.f, 1.f }, { 0.f, 1.f }, { -1.f, 1.f }, { -1.f, 0.f }
+	};
+
+	auto outline_abgr = outline_color.to_hex_abgr();
+	for (const auto& offset : offsets)
+		add_glyph_run(run, origin + offset * outline_size, outline_abgr);
 
 	// add actual text
-	add_text(top_left, size, text, text_color, font_size, flags);
+	add_glyph_run(run, origin, text_color.to_hex_abgr());
 }
 
 void renderer::add_outlined_text_with_bg(const vec2& top_left, const vec2& size, const std::wstring& text, const color& text_color, const color& outline_color, const color& bg_color, float font_size, float outline_size, text_align text_flags)
+{
+	add_outlined_text_with_bg(top_left, size, text, text_color, outline_color, bg_color, get_font(font_size), outline_size, text_flags);
+}
+
+void renderer::add_outlined_text_with_bg(const vec2& top_left, const vec2& size, const std::wstring& text, const color& text_color, const color& outline_color, const color& bg_color, font_handle text_font, float outline_size, text_align text_flags)
 {
 	if (text.empty())
 		return;
 
 	auto final_flags = static_cast<uint32_t>(text_flags) | FW1_NOFLUSH | FW1_NOWORDWRAP;
 
-	// rect for formatting text
-	FW1_RECTF rect{ top_left.x, top_left.y, top_left.x + size.x, top_left.y + size.y };
-
 	// rect for drawing background behind text
 	FW1_RECTF text_box_rect{ top_left.x, top_left.y, top_left.x, top_left.y };
-	FW1_RECTF text_box = p_font_wrapper->MeasureString(text.c_str(), L"Consolas", font_size, &text_box_rect, final_flags);
+	FW1_RECTF text_box = measure_string(text, text_font, text_box_rect, final_flags);
 
 	add_rect_filled({ text_box.Left - outline_size, text_box.Top }, { text_box.Right - text_box.Left + outline_size + 1.f, text_box.Bottom - text_box.Top }, bg_color);
 
-	add_outlined_text(top_left, size, text, text_color, outline_color, font_size, outline_size, text_flags);
-	//p_font_wrapper->AnalyzeString(nullptr, text.c_str(), L"Consolas", font_size, &rect, text_color.to_hex_abgr(), final_flags, default_draw_list.p_text_geometry);
-
+	add_outlined_text(top_left, size, text, text_color, outline_color, text_font, outline_size, text_flags);
 }
 
 void renderer::add_frame(const vec2& top_left, const vec2& size, float thickness, const color& frame_color)
@@ -540,12 +1213,69 @@ void renderer::add_outlined_frame(const vec2& top_left, const vec2& size, float
 }
 
 vec2 renderer::measure_text(const std::wstring& text, float text_size)
+{
+	return measure_text(text, get_font(text_size));
+}
+
+vec2 renderer::measure_text(const std::wstring& text, font_handle text_font)
 {
 	FW1_RECTF in{};
-	auto rect = p_font_wrapper->MeasureString(text.c_str(), font.c_str(), text_size, &in, FW1_LEFT | FW1_NOWORDWRAP);
+	auto rect = measure_string(text, text_font, in, FW1_LEFT | FW1_NOWORDWRAP);
 	return { rect.Right - rect.Left, rect.Bottom - rect.Top };
 }
 
+draw_list_stats renderer::get_last_frame_stats() const
+{
+	return last_frame_stats;
+}
+
+void renderer::set_text_cache_memory_cap(size_t memory_cap)
+{
+	std::lock_guard lock{ text_mutex };
+	text_cache.set_memory_cap(memory_cap);
+}
+
+text_cache_stats renderer::get_text_cache_stats() const
+{
+	std::lock_guard lock{ text_mutex };
+	return text_cache.get_stats();
+}
+
+font_handle renderer::create_font(const std::wstring& family, float size, DWRITE_FONT_WEIGHT weight)
+{
+	std::lock_guard lock{ text_mutex };
+
+	for (auto i = 0u; i < fonts.size(); ++i)
+	{
+		if (fonts[i].family == family && fonts[i].size == size && fonts[i].weight == weight)
+			return { i };
+	}
+
+	font_entry entry{ family, size, weight, nullptr, nullptr, {} };
+
+	if (FAILED(p_dwrite_factory->CreateTextFormat(family.c_str(), nullptr, weight, DWRITE_FONT_STYLE_NORMAL, DWRITE_FONT_STRETCH_NORMAL, size, L"", &entry.p_text_format)))
+		handle_error("create_font - failed to create text format");
+
+	setup_font_metrics(entry);
+
+	fonts.push_back(std::move(entry));
+	return { static_cast<uint32_t>(fonts.size() - 1) };
+}
+
+font_handle renderer::get_font(float size)
+{
+	std::lock_guard lock{ text_mutex };
+
+	auto it = default_fonts.find(size);
+	if (it != default_fonts.end())
+		return it->second;
+
+	auto handle = create_font(font, size);
+	default_fonts.emplace(size, handle);
+
+	return handle;
+}
+
 //
 // [public] constructors
 //
@@ -557,15 +1287,37 @@ renderer::renderer() :
 	p_device_context(nullptr),
 	p_backbuffer(nullptr),
 	p_layout(nullptr),
+	p_precise_layout(nullptr),
 	p_blend_state(nullptr),
 	p_depth_stencil(nullptr),
 	p_vertex_shader(nullptr),
 	p_pixel_shader(nullptr),
-	p_vertex_buffer(nullptr),
 	p_screen_projection_buffer(nullptr),
+	vertex_buffer(D3D11_BIND_VERTEX_BUFFER, sizeof(vertex), INITIAL_DRAW_LIST_VERTICES),
+	precise_vertex_buffer(D3D11_BIND_VERTEX_BUFFER, sizeof(precise_vertex), INITIAL_DRAW_LIST_PRECISE_VERTICES),
+	index_buffer(D3D11_BIND_INDEX_BUFFER, sizeof(draw_index), INITIAL_DRAW_LIST_INDICES),
+	p_rasterizer_state(nullptr),
 	p_font_factory(nullptr),
 	p_font_wrapper(nullptr),
+	p_glyph_atlas(nullptr),
+	p_glyph_provider(nullptr),
+	p_scratch_text_geometry(nullptr),
+	p_dwrite_factory(nullptr),
 	default_draw_list(),
+	last_frame_stats(),
+	frame_dirty(true),
+	max_idle_interval(0.f),
+	last_present_time(),
+	idle_frame_count(0),
+	geometry_generation(1),
+	placeholder_generation(1),
+	async_glyphs(false),
+	text_cache(DEFAULT_TEXT_CACHE_MEMORY_CAP),
+	fonts(),
+	default_fonts(),
+	circle_tables(),
+	filled_circle_tables(),
+	circle_max_error(DEFAULT_CIRCLE_MAX_ERROR),
 	screen_projection(),
 	render_target_color()
 { }
@@ -633,6 +1385,9 @@ void renderer::setup_viewport(HWND hwnd)
 	viewport.MaxDepth = 1.f;
 
 	p_device_context->RSSetViewports(1, &viewport);
+
+	// anything recorded without a clip rect gets scissored to the whole viewport
+	default_draw_list.set_viewport({ { viewport.TopLeftX, viewport.TopLeftY }, { viewport.Width, viewport.Height } });
 }
 
 void renderer::setup_shaders()
@@ -650,37 +1405,48 @@ void renderer::setup_shaders()
 
 void renderer::setup_input_layout()
 {
-	// create the input layout object
+	// create the input layout object, the vertex shader only reads POSITION.xy so both layouts share the same shader
 	D3D11_INPUT_ELEMENT_DESC input_elem_desc[] =
 	{
-		{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
-		{"COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0},
+		{"POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
+		{"COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, 8, D3D11_INPUT_PER_VERTEX_DATA, 0},
 	};
 
 	if (FAILED(p_device->CreateInputLayout(input_elem_desc, 2, shaders::vertex, sizeof(shaders::vertex), &p_layout)))
 		handle_error("renderer - failed to create input layout");
 
+	// create the input layout for opted in precise vertices
+	D3D11_INPUT_ELEMENT_DESC precise_input_elem_desc[] =
+	{
+		{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
+		{"COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0},
+	};
+
+	if (FAILED(p_device->CreateInputLayout(precise_input_elem_desc, 2, shaders::vertex, sizeof(shaders::vertex), &p_precise_layout)))
+		handle_error("renderer - failed to create precise input layout");
+
 	// this use to be after we set constant projection buffer
 	p_device_context->IASetInputLayout(p_layout);
 }
 
 void renderer::setup_vertex_buffer()
 {
-	// create the vertex buffer
-	D3D11_BUFFER_DESC bd;
-	ZeroMemory(&bd, sizeof(bd));
+	if (FAILED(vertex_buffer.create(p_device)))
+		handle_error("renderer - failed to create vertex buffer");
 
-	bd.Usage = D3D11_USAGE_DYNAMIC;							// write access access by CPU and GPU
-	bd.ByteWidth = sizeof(vertex) * MAX_DRAW_LIST_VERTICES; // size is the VERTEX struct * max vertices
-	bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;				// use as a vertex buffer
-	bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;				// allow CPU to write in buffer
+	// the precise vertex buffer is only used for gradients that opt in, so it starts a lot smaller
+	if (FAILED(precise_vertex_buffer.create(p_device)))
+		handle_error("renderer - failed to create precise vertex buffer");
 
-	if (FAILED(p_device->CreateBuffer(&bd, NULL, &p_vertex_buffer)))	// create the buffer
-		handle_error("renderer - failed to create vertex buffer");
+	bind_vertex_format(vertex_format::packed);
+}
 
-	UINT stride = sizeof(vertex);
-	UINT offset = 0;
-	p_device_context->IASetVertexBuffers(0, 1, &p_vertex_buffer, &stride, &offset);
+void renderer::setup_index_buffer()
+{
+	if (FAILED(index_buffer.create(p_device)))
+		handle_error("renderer - failed to create index buffer");
+
+	p_device_context->IASetIndexBuffer(index_buffer.get(), DXGI_FORMAT_R32_UINT, 0);
 }
 
 void renderer::setup_blend_state()
@@ -722,20 +1488,17 @@ void renderer::setup_depth_stencil_state()
 
 void renderer::setup_rasterizer_state()
 {
-	ID3D11RasterizerState* p_rasterizer_state;
 	D3D11_RASTERIZER_DESC rasterizer_desc;
 	ZeroMemory(&rasterizer_desc, sizeof(rasterizer_desc));
 	rasterizer_desc.FillMode = D3D11_FILL_SOLID;
 	rasterizer_desc.CullMode = D3D11_CULL_BACK;
-	rasterizer_desc.ScissorEnable = false;
+	rasterizer_desc.ScissorEnable = true; // each batch sets its clip rect as the scissor rect
 	rasterizer_desc.DepthClipEnable = true;
 
 	if (FAILED(p_device->CreateRasterizerState(&rasterizer_desc, &p_rasterizer_state)))
 		handle_error("setup_rasterizer_state - failed to create rasterizer state");
 
 	p_device_context->RSSetState(p_rasterizer_state);
-
-	p_rasterizer_state->Release();
 }
 
 void renderer::setup_screen_projection()
@@ -783,57 +1546,512 @@ void renderer::setup_font_renderer(std::wstring font)
 	if (FAILED(p_font_factory->CreateFontWrapper(p_device, font.c_str(), &p_font_wrapper)))
 		handle_error("renderer - failed to create font wrapper");
 
+	// cached glyph runs and captured geometry index into the old glyph atlas
+	text_cache.clear();
+	geometry_generation++;
+
+	safe_release(p_glyph_atlas);
+	if (FAILED(p_font_wrapper->GetGlyphAtlas(&p_glyph_atlas)))
+		handle_error("renderer - failed to get glyph atlas");
+
+	safe_release(p_glyph_provider);
+	if (FAILED(p_font_wrapper->GetGlyphProvider(&p_glyph_provider)))
+		handle_error("renderer - failed to get glyph provider");
+
+	safe_release(p_scratch_text_geometry);
+	if (FAILED(p_font_factory->CreateTextGeometry(&p_scratch_text_geometry)))
+		handle_error("renderer - failed to create scratch text geometry");
+
+	safe_release(p_dwrite_factory);
+	if (FAILED(p_font_wrapper->GetDWriteFactory(&p_dwrite_factory)))
+		handle_error("renderer - failed to get directwrite factory");
+
 	p_font_wrapper->DrawString(p_device_context, L"", 0.0f, 0.0f, 0.0f, 0xff000000, FW1_RESTORESTATE | FW1_NOFLUSH);
 }
 
+void renderer::setup_font_metrics(font_entry& entry)
+{
+	// without a font face text is measured by DirectWrite, so nothing here is fatal
+	IDWriteFontCollection* p_font_collection = nullptr;
+	IDWriteFontFamily* p_font_family = nullptr;
+	IDWriteFont* p_dwrite_font = nullptr;
+
+	UINT32 family_index = 0;
+	BOOL family_exists = FALSE;
+
+	if (SUCCEEDED(entry.p_text_format->GetFontCollection(&p_font_collection)) && p_font_collection &&
+		SUCCEEDED(p_font_collection->FindFamilyName(entry.family.c_str(), &family_index, &family_exists)) && family_exists &&
+		SUCCEEDED(p_font_collection->GetFontFamily(family_index, &p_font_family)) &&
+		SUCCEEDED(p_font_family->GetFirstMatchingFont(entry.weight, DWRITE_FONT_STRETCH_NORMAL, DWRITE_FONT_STYLE_NORMAL, &p_dwrite_font)) &&
+		SUCCEEDED(p_dwrite_font->CreateFontFace(&entry.p_font_face)))
+	{
+		DWRITE_FONT_METRICS face_metrics;
+		entry.p_font_face->GetMetrics(&face_metrics);
+
+		entry.metrics.design_units_per_em = static_cast<float>(face_metrics.designUnitsPerEm);
+		entry.metrics.line_height = static_cast<float>(face_metrics.ascent + face_metrics.descent + face_metrics.lineGap);
+
+		// printable ascii all sharing one advance makes measuring it a multiply
+		auto first_advance = get_glyph_advance(entry, L' ');
+		auto monospaced = first_advance > 0.f;
+
+		for (wchar_t character = 0x21; character < 0x7f && monospaced; ++character)
+			monospaced = get_glyph_advance(entry, character) == first_advance;
+
+		entry.metrics.ascii_advance = monospaced ? first_advance : 0.f;
+	}
+
+	safe_release(p_dwrite_font);
+	safe_release(p_font_family);
+	safe_release(p_font_collection);
+}
+
 //
 // [private] internal helper functions
 //
 
-void renderer::add_vertex(const vertex& vertex, const D3D_PRIMITIVE_TOPOLOGY type)
+template <typename Ty>
+std::span<Ty> renderer::prim_reserve(size_t vertex_count, D3D_PRIMITIVE_TOPOLOGY type)
+{
+	if (!draw_list::is_supported_topology(type))
+		handle_error("prim_reserve - primitive topology is not supported by the draw list");
+
+	return get_draw_list().prim_reserve<Ty>(vertex_count, type);
+}
+
+template std::span<vertex> renderer::prim_reserve<vertex>(size_t vertex_count, D3D_PRIMITIVE_TOPOLOGY type);
+template std::span<precise_vertex> renderer::prim_reserve<precise_vertex>(size_t vertex_count, D3D_PRIMITIVE_TOPOLOGY type);
+
+draw_list& renderer::get_draw_list()
+{
+	return p_thread_draw_list ? *p_thread_draw_list : default_draw_list;
+}
+
+size_t renderer::resolve_circle_segments(float radius, size_t segments) const
 {
-	if (default_draw_list.vertices.size() >= MAX_DRAW_LIST_VERTICES)
+	return segments ? segments : calc_circle_segments(radius, circle_max_error);
+}
+
+const circle_table& renderer::get_circle_table(size_t segments, bool filled)
+{
+	auto& tables = filled ? filled_circle_tables : circle_tables;
+
+	// tables are never erased and map nodes do not move, so the returned reference stays valid without the lock
+	std::lock_guard lock{ circle_table_mutex };
+
+	auto cached_table = tables.find(segments);
+	if (cached_table != tables.end())
+		return cached_table->second;
+
+	// for each circle resolution(segments), we only need to calculate the unit circle once to avoid calling calc_theta(), sin(), and cos() every call
+	circle_table table{};
+
+	auto add_point = [&table, segments](size_t vertex_n)
+	{
+		auto theta = calc_theta(vertex_n, segments);
+		table.x.push_back(std::cos(theta));
+		table.y.push_back(std::sin(theta));
+	};
+
+	if (!filled)
 	{
-		handle_error("vertex buffer limit reached, did you forget to call renderer::draw()?");
-		draw();
+		// outlines go all the way around and end on the first point again
+		for (auto i = 0u; i <= segments; ++i)
+			add_point(i);
 	}
-	if (default_draw_list.batch_list.empty() || default_draw_list.batch_list.back().type != type)
-		default_draw_list.batch_list.emplace_back(type, 1);
 	else
-		default_draw_list.batch_list.back().vertex_count++;
+	{
+		// vertices 1, 2 and 3 need to be added first
+		add_point(0);
+		add_point(1);
+		add_point(segments - 1);
+
+		// for the 4th, 5th, ... nth vertex, its position is dependant on its nth number becuase of trianglestrips
+		for (auto list_place = 4u; list_place <= segments; ++list_place)
+		{
+			// calculate where on the circle the vertex needs to calculated from vertex order for 8 segments the clockwise order is goes 1,2,4,6,8,7,5,3
+			add_point(list_place % 2 != 0 ? segments - list_place / 2 : list_place / 2);
+		}
+	}
+
+	return tables.emplace(segments, std::move(table)).first->second;
+}
+
+bool renderer::clip_rect(vec2& top_left, vec2& size)
+{
+	// flipped rects are only culled, trimming is left to the scissor rect
+	if (size.x < 0.f || size.y < 0.f)
+	{
+		auto bottom_right = top_left + size;
+		vec2 min{ (std::min)(top_left.x, bottom_right.x), (std::min)(top_left.y, bottom_right.y) };
+		return is_visible({ min, vec2{ std::fabs(size.x), std::fabs(size.y) } });
+	}
+
+	if (!is_visible({ top_left, size }))
+		return false;
+
+	auto clipped = region{ top_left, size }.intersect(get_draw_list().get_clip_rect());
+	top_left = clipped.top_left;
+	size = clipped.size;
 
-	default_draw_list.vertices.push_back(vertex);
+	return true;
 }
 
-void renderer::add_vertices(vertex* p_vertices, const size_t vertex_count, const D3D_PRIMITIVE_TOPOLOGY type)
+bool renderer::is_visible(const region& bounds)
 {
-	if (vertex_count > MAX_DRAW_LIST_VERTICES)
-		handle_error("add_vertices - trying to add too many vertices");
+	if (bounds.intersects(get_draw_list().get_clip_rect()))
+		return true;
 
-	if (default_draw_list.vertices.size() + vertex_count >= MAX_DRAW_LIST_VERTICES)
+	get_draw_list().culled_count++;
+	return false;
+}
+
+IDWriteTextLayout* renderer::create_text_layout(const std::wstring& text, font_handle text_font, const FW1_RECTF& rect, uint32_t flags)
+{
+	if (text_font.index >= fonts.size())
+		handle_error("create_text_layout - invalid font handle");
+
+	IDWriteTextLayout* p_text_layout = nullptr;
+	if (FAILED(p_dwrite_factory->CreateTextLayout(text.c_str(), static_cast<UINT32>(text.size()), fonts[text_font.index].p_text_format, rect.Right - rect.Left, rect.Bottom - rect.Top, &p_text_layout)))
+		return nullptr;
+
+	if (flags & FW1_NOWORDWRAP)
+		p_text_layout->SetWordWrapping(DWRITE_WORD_WRAPPING_NO_WRAP);
+
+	if (flags & FW1_RIGHT)
+		p_text_layout->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_TRAILING);
+	else if (flags & FW1_CENTER)
+		p_text_layout->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_CENTER);
+
+	if (flags & FW1_BOTTOM)
+		p_text_layout->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_FAR);
+	else if (flags & FW1_VCENTER)
+		p_text_layout->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_CENTER);
+
+	return p_text_layout;
+}
+
+FW1_RECTF renderer::measure_string(const std::wstring& text, font_handle text_font, const FW1_RECTF& layout_rect, uint32_t flags)
+{
+	std::lock_guard lock{ text_mutex };
+
+	if (text_font.index >= fonts.size())
+		handle_error("measure_string - invalid font handle");
+
+	auto& entry = fonts[text_font.index];
+
+	auto width = 0.f, trailing_width = 0.f;
+	if (!measure_single_line(entry, text, width, trailing_width))
+	{
+		// the layout box of the lines, like the fast path measures it, not the ink bounds MeasureString returns
+		FW1_RECTF text_rect{ layout_rect.Left, layout_rect.Top, layout_rect.Left, layout_rect.Top };
+
+		if (auto p_text_layout = create_text_layout(text, text_font, layout_rect, flags))
+		{
+			DWRITE_TEXT_METRICS text_metrics;
+			if (SUCCEEDED(p_text_layout->GetMetrics(&text_metrics)))
+			{
+				text_rect.Left = std::floor(layout_rect.Left + text_metrics.left);
+				text_rect.Top = std::floor(layout_rect.Top + text_metrics.top);
+				text_rect.Right = std::ceil(layout_rect.Left + text_metrics.left + text_metrics.widthIncludingTrailingWhitespace);
+				text_rect.Bottom = std::ceil(layout_rect.Top + text_metrics.top + text_metrics.height);
+			}
+
+			p_text_layout->Release();
+		}
+
+		return text_rect;
+	}
+
+	auto scale = entry.size / entry.metrics.design_units_per_em;
+	vec2 text_size{ width * scale, entry.metrics.line_height * scale };
+
+	// place the line the same way DirectWrite aligns it inside the layout rect, trailing spaces hang past the aligned edge
+	vec2 text_pos{ layout_rect.Left, layout_rect.Top };
+	auto aligned_width = (width - trailing_width) * scale;
+
+	if (flags & FW1_CENTER)
+		text_pos.x += (layout_rect.Right - layout_rect.Left - aligned_width) * 0.5f;
+	else if (flags & FW1_RIGHT)
+		text_pos.x = layout_rect.Right - aligned_width;
+
+	if (flags & FW1_VCENTER)
+		text_pos.y += (layout_rect.Bottom - layout_rect.Top - text_size.y) * 0.5f;
+	else if (flags & FW1_BOTTOM)
+		text_pos.y = layout_rect.Bottom - text_size.y;
+
+	return { std::floor(text_pos.x), std::floor(text_pos.y), std::ceil(text_pos.x + text_size.x), std::ceil(text_pos.y + text_size.y) };
+}
+
+bool renderer::measure_single_line(font_entry& entry, const std::wstring& text, float& width, float& trailing_width)
+{
+	if (!entry.p_font_face)
+		return false;
+
+	size_t ascii_count = 0;
+	width = 0.f;
+
+	for (auto character : text)
+	{
+		// c0 and c1 control characters and surrogate pairs need a real layout
+		if (character < 0x20 || (character >= 0x7f && character <= 0x9f) || (character >= 0xd800 && character <= 0xdfff))
+			return false;
+
+		if (entry.metrics.ascii_advance > 0.f && character < 0x7f)
+		{
+			ascii_count++;
+			continue;
+		}
+
+		auto advance = get_glyph_advance(entry, character);
+
+		// DirectWrite would fall back to another font for this character
+		if (advance <= 0.f)
+			return false;
+
+		width += advance;
+	}
+
+	width += static_cast<float>(ascii_count) * entry.metrics.ascii_advance;
+
+	auto last_non_space = text.find_last_not_of(L' ');
+	auto trailing_count = last_non_space == std::wstring::npos ? text.size() : text.size() - last_non_space - 1;
+	trailing_width = trailing_count > 0 ? static_cast<float>(trailing_count) * get_glyph_advance(entry, L' ') : 0.f;
+
+	return true;
+}
+
+float renderer::get_glyph_advance(font_entry& entry, wchar_t character)
+{
+	auto it = entry.metrics.advances.find(character);
+	if (it != entry.metrics.advances.end())
+		return it->second;
+
+	auto advance = 0.f;
+	UINT32 code_point = character;
+	UINT16 glyph_index = 0;
+
+	if (SUCCEEDED(entry.p_font_face->GetGlyphIndices(&code_point, 1, &glyph_index)) && glyph_index != 0)
+	{
+		DWRITE_GLYPH_METRICS glyph_metrics;
+		if (SUCCEEDED(entry.p_font_face->GetDesignGlyphMetrics(&glyph_index, 1, &glyph_metrics, FALSE)))
+			advance = static_cast<float>(glyph_metrics.advanceWidth);
+	}
+
+	entry.metrics.advances.emplace(character, advance);
+	return advance;
+}
+
+glyph_run_ptr renderer::get_text_layout(const std::wstring& text, font_handle text_font, const FW1_RECTF& rect, uint32_t flags)
+{
+	if (async_glyphs)
+		flags |= FW1_ASYNCGLYPHS;
+
+	vec2 origin_fraction{ rect.Left - std::floor(rect.Left), rect.Top - std::floor(rect.Top) };
+	text_layout_cache::key layout_key{ text, text_font.index, flags, { rect.Right - rect.Left, rect.Bottom - rect.Top }, origin_fraction };
+
+	// a miss keeps the lock while laying out, the fonts and the scratch geometry are shared by every thread
+	std::lock_guard lock{ text_mutex };
+
+	if (auto p_glyphs = text_cache.find(layout_key))
+		return p_glyphs;
+
+	// lay the text out at the sub pixel part of the origin so the run lines up with a layout at the real origin once translated
+	FW1_RECTF local_rect{ origin_fraction.x, origin_fraction.y, origin_fraction.x + layout_key.rect_size.x, origin_fraction.y + layout_key.rect_size.y };
+
+	p_scratch_text_geometry->Clear();
+
+	// layouts are serialized by the lock, so any placeholder handed out meanwhile went into this run
+	auto placeholder_count = p_glyph_provider->GetPlaceholderCount();
+
+	if (auto p_text_layout = create_text_layout(text, text_font, local_rect, flags))
+	{
+		p_font_wrapper->AnalyzeTextLayout(nullptr, p_text_layout, local_rect.Left, local_rect.Top, 0xffffffff, flags, p_scratch_text_geometry);
+		p_text_layout->Release();
+	}
+
+	// vertices come back sorted by sheet with the sheet index masked out of GlyphIndex, so it gets put back in
+	auto vertex_data = p_scratch_text_geometry->GetGlyphVerticesTemp();
+	auto p_glyph = vertex_data.pVertices;
+
+	glyph_run run{ {}, p_glyph_provider->GetPlaceholderCount() != placeholder_count };
+	run.glyphs.reserve(vertex_data.TotalVertexCount);
+
+	for (UINT sheet_index = 0; sheet_index < vertex_data.SheetCount; ++sheet_index)
 	{
-		handle_error("vertex buffer limit reached, did you forget to call renderer::draw()?");
-		draw();
+		for (UINT i = 0; i < vertex_data.pVertexCounts[sheet_index]; ++i, ++p_glyph)
+		{
+			run.glyphs.push_back(*p_glyph);
+			run.glyphs.back().GlyphIndex |= sheet_index << 16;
+		}
+	}
+
+	return text_cache.insert(layout_key, std::move(run));
+}
+
+void renderer::analyze_text(const std::wstring& text, font_handle text_font, const FW1_RECTF& rect, uint32_t abgr, uint32_t flags)
+{
+	auto p_glyphs = get_text_layout(text, text_font, rect, flags);
+	add_glyph_run(*p_glyphs, { std::floor(rect.Left), std::floor(rect.Top) }, abgr);
+}
+
+void renderer::add_glyph_run(const glyph_run& run, const vec2& origin, uint32_t abgr)
+{
+	auto& list = get_draw_list();
+	const auto& glyphs = run.glyphs;
+
+	if (run.has_placeholders)
+		list.placeholder_run_count++;
+	auto clipped = list.is_clipped();
+
+	UINT coords_sheet = UINT_MAX;
+	const FW1_GLYPHCOORDS* p_coords = nullptr;
+
+	list.reserve_storage(list.glyphs, list.glyphs.size() + glyphs.size());
+	auto first_glyph = list.glyphs.size();
+
+	for (auto glyph : glyphs)
+	{
+		glyph.PositionX += origin.x;
+		glyph.PositionY += origin.y;
+		glyph.GlyphColor = abgr;
+
+		// without a clip rect anything off screen is already discarded by the gpu
+		if (clipped)
+		{
+			auto sheet_index = glyph.GlyphIndex >> 16;
+			if (sheet_index != coords_sheet)
+			{
+				p_coords = p_glyph_atlas->GetGlyphCoords(sheet_index);
+				coords_sheet = sheet_index;
+			}
+
+			if (p_coords)
+			{
+				const auto& coords = p_coords[glyph.GlyphIndex & 0xffff];
+				region quad{ { glyph.PositionX + coords.PositionLeft, glyph.PositionY + coords.PositionTop }, { coords.PositionRight - coords.PositionLeft, coords.PositionBottom - coords.PositionTop } };
+
+				// glyphs that are only partially visible get trimmed when their glyph batch is drawn
+				if (!is_visible(quad))
+					continue;
+			}
+		}
+
+		list.glyphs.push_back(glyph);
+	}
+
+	list.append_glyph_batch(list.get_clip_rect(), list.glyphs.size() - first_glyph);
+}
+
+void renderer::submit_glyphs()
+{
+	auto& list = default_draw_list;
+	auto p_glyph = list.glyphs.data();
+
+	// the font wrapper uses its own rasterizer state, so the scissor rect does not apply to glyphs
+	// glyphs recorded under a clip rect are drawn with its clipping shaders instead, those trim partially visible glyphs
+	for (const auto& glyph_batch : list.glyph_batches)
+	{
+		list.p_text_geometry->Clear();
+		for (auto i = 0u; i < glyph_batch.glyph_count; ++i)
+			list.p_text_geometry->AddGlyphVertex(p_glyph++);
+
+		if (glyph_batch.clip == list.viewport)
+		{
+			p_font_wrapper->DrawGeometry(p_device_context, list.p_text_geometry, nullptr, nullptr, FW1_RESTORESTATE);
+			continue;
+		}
+
+		FW1_RECTF clip_rect
+		{
+			glyph_batch.clip.top_left.x,
+			glyph_batch.clip.top_left.y,
+			glyph_batch.clip.top_left.x + glyph_batch.clip.size.x,
+			glyph_batch.clip.top_left.y + glyph_batch.clip.size.y
+		};
+
+		p_font_wrapper->DrawGeometry(p_device_context, list.p_text_geometry, &clip_rect, nullptr, FW1_CLIPRECT | FW1_RESTORESTATE);
 	}
+}
+
+void renderer::bind_vertex_format(vertex_format format)
+{
+	UINT offset = 0;
 
-	if (default_draw_list.batch_list.empty() || default_draw_list.batch_list.back().type != type)
-		default_draw_list.batch_list.emplace_back(type, vertex_count);
+	if (format == vertex_format::precise)
+	{
+		UINT stride = sizeof(precise_vertex);
+		auto p_buffer = precise_vertex_buffer.get();
+		p_device_context->IASetInputLayout(p_precise_layout);
+		p_device_context->IASetVertexBuffers(0, 1, &p_buffer, &stride, &offset);
+	}
 	else
-		default_draw_list.batch_list.back().vertex_count += vertex_count;
+	{
+		UINT stride = sizeof(vertex);
+		auto p_buffer = vertex_buffer.get();
+		p_device_context->IASetInputLayout(p_layout);
+		p_device_context->IASetVertexBuffers(0, 1, &p_buffer, &stride, &offset);
+	}
+}
 
-	// store old size for our memcpy destination address
-	auto old_size = default_draw_list.vertices.size();
+void renderer::submit_draw_list()
+{
+	size_t vertex_offset = 0;
+	size_t precise_vertex_offset = 0;
+	size_t index_offset = 0;
 
-	// resize our vertex buffer so we can copy the new vertices in
-	default_draw_list.vertices.resize(old_size + vertex_count);
-	memcpy(&default_draw_list.vertices[old_size], p_vertices, vertex_count * sizeof(vertex));
+	// upload everything at the end of each ring, the buffers grow instead of splitting the frame when it does not fit
+	if (FAILED(vertex_buffer.upload(p_device, p_device_context, default_draw_list.vertices.data(), default_draw_list.vertices.size(), vertex_offset)))
+		return;
 
-	// we need to add a vertex between these primitives otherwise it will connect them
-	if (type == D3D_PRIMITIVE_TOPOLOGY_LINESTRIP ||
-		type == D3D_PRIMITIVE_TOPOLOGY_LINESTRIP_ADJ ||
-		type == D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP ||
-		type == D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP_ADJ)
-		add_vertex({}, D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED);
+	// precise vertices are opt in, so only touch their buffer if something was recorded with them
+	if (default_draw_list.precise_vertices.size() &&
+		FAILED(precise_vertex_buffer.upload(p_device, p_device_context, default_draw_list.precise_vertices.data(), default_draw_list.precise_vertices.size(), precise_vertex_offset)))
+		return;
+
+	if (FAILED(index_buffer.upload(p_device, p_device_context, default_draw_list.indices.data(), default_draw_list.indices.size(), index_offset)))
+		return;
+
+	// the rings can be recreated when they grow, so bind them every frame
+	p_device_context->IASetIndexBuffer(index_buffer.get(), DXGI_FORMAT_R32_UINT, 0);
+	bind_vertex_format(vertex_format::packed);
+
+	// everything in the draw list is a triangle list, so each batch is a single indexed draw
+	p_device_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	auto bound_format = vertex_format::packed;
+	const region* p_bound_clip = nullptr;
+	for (auto& batch : default_draw_list.batch_list)
+	{
+		if (batch.format != bound_format)
+		{
+			bind_vertex_format(batch.format);
+			bound_format = batch.format;
+		}
+
+		if (!p_bound_clip || !(*p_bound_clip == batch.clip))
+		{
+			D3D11_RECT scissor_rect
+			{
+				static_cast<LONG>(std::floor(batch.clip.top_left.x)),
+				static_cast<LONG>(std::floor(batch.clip.top_left.y)),
+				static_cast<LONG>(std::ceil(batch.clip.top_left.x + batch.clip.size.x)),
+				static_cast<LONG>(std::ceil(batch.clip.top_left.y + batch.clip.size.y))
+			};
+
+			p_device_context->RSSetScissorRects(1, &scissor_rect);
+			p_bound_clip = &batch.clip;
+		}
+
+		auto base_vertex = batch.format == vertex_format::precise ? precise_vertex_offset : vertex_offset;
+
+		p_device_context->DrawIndexed(static_cast<UINT>(batch.index_count), static_cast<UINT>(index_offset), static_cast<INT>(base_vertex));
+		index_offset += batch.index_count;
+	}
+
+	// leave the packed format bound for the next frame
+	if (bound_format != vertex_format::packed)
+		bind_vertex_format(vertex_format::packed);
 }
 
 renderer::~renderer()
@@ -847,11 +2065,23 @@ renderer::~renderer()
 	safe_release(p_backbuffer);
 	safe_release(p_blend_state);
 	safe_release(p_layout);
+	safe_release(p_precise_layout);
 	safe_release(p_vertex_shader);
 	safe_release(p_pixel_shader);
-	safe_release(p_vertex_buffer);
 	safe_release(p_screen_projection_buffer);
 	safe_release(p_font_factory);
+	safe_release(p_rasterizer_state);
+	safe_release(p_scratch_text_geometry);
+	safe_release(p_glyph_atlas);
+	safe_release(p_glyph_provider);
+
+	for (auto& entry : fonts)
+	{
+		safe_release(entry.p_text_format);
+		safe_release(entry.p_font_face);
+	}
+
+	safe_release(p_dwrite_factory);
 	safe_release(p_font_wrapper);
 }
 
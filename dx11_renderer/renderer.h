@@ -8,9 +8,16 @@
 #include <cstddef>
 #include <cmath>
 #include <vector>
+#include <span>
 #include <string>
 #include <unordered_map>
+#include <list>
+#include <memory>
+#include <string_view>
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <mutex>
 //#include <d3dx11.h>
 #include <DirectXMath.h>
 
@@ -18,22 +25,97 @@
 
 #include "renderer_utils.h"
 
-// holds a vertex buffer and a batch list that our renderer will use
+// geometry copied out of a draw list so it can be added again in later frames without being recorded, see renderer::begin_geometry_capture
+struct geometry_cache
+{
+	std::vector<vertex> vertices;
+	std::vector<precise_vertex> precise_vertices;
+	std::vector<draw_index> indices;	  // relative to the first cached vertex of the batch's vertex format
+	std::vector<batch> batch_list;		  // batches keep the clip rect they were recorded with
+	std::vector<FW1_GLYPHVERTEX> glyphs;
+	std::vector<glyph_batch> glyph_batches; // glyphs keep the clip rect they were recorded with as well
+	size_t primitive_count;
+	uint32_t generation;				  // renderer geometry generation it was captured in, 0 if nothing was captured
+	bool has_placeholder_glyphs;		  // some glyphs stand in for glyphs that were still being rasterized
+	uint32_t placeholder_generation;	  // renderer placeholder generation it was captured in, only checked with placeholder glyphs
+
+	geometry_cache() :
+		vertices(),
+		precise_vertices(),
+		indices(),
+		batch_list(),
+		glyphs(),
+		glyph_batches(),
+		primitive_count(0),
+		generation(0),
+		has_placeholder_glyphs(false),
+		placeholder_generation(0)
+	{}
+
+	// drop the cached geometry, storage capacity is kept for the next capture
+	void clear()
+	{
+		vertices.clear();
+		precise_vertices.clear();
+		indices.clear();
+		batch_list.clear();
+		glyphs.clear();
+		glyph_batches.clear();
+		primitive_count = 0;
+		generation = 0;
+		has_placeholder_glyphs = false;
+		placeholder_generation = 0;
+	}
+};
+
+// holds a vertex buffer, an index buffer and a batch list that our renderer will use
+// every primitive is converted to indexed triangles when it is recorded, so a frame only needs one topology
+// threads can record into their own draw lists, see renderer::set_thread_draw_list
 class draw_list
 {
 	friend class renderer;
 public:
 	draw_list() :
 		vertices(),
+		precise_vertices(),
+		indices(),
 		batch_list(),
+		glyphs(),
+		glyph_batches(),
+		clip_stack(),
+		viewport(),
+		primitive_count(0),
+		allocation_count(0),
+		culled_count(0),
+		placeholder_run_count(0),
+		pending{ D3D_PRIMITIVE_TOPOLOGY_UNDEFINED, vertex_format::packed, 0, 0 },
+		capture_start(),
+		capturing(false),
 		p_text_geometry(nullptr)
 	{}
 
+	draw_list(const draw_list&) = delete;
+
+	// clears recorded geometry, storage capacity is kept so following frames do not allocate
 	void clear()
 	{
 		vertices.clear();
+		precise_vertices.clear();
+		indices.clear();
 		batch_list.clear();
-		p_text_geometry->Clear();
+		glyphs.clear();
+		glyph_batches.clear();
+		clip_stack.clear();
+		primitive_count = 0;
+		allocation_count = 0;
+		culled_count = 0;
+		placeholder_run_count = 0;
+		pending.type = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+		capturing = false;
+
+		// only the renderer's own draw list has text geometry, other lists keep their glyphs until they are spliced into it
+		if (p_text_geometry)
+			p_text_geometry->Clear();
 	}
 
 	HRESULT init_text_geometry(IFW1Factory* font_factory)
@@ -41,15 +123,236 @@ public:
 		return font_factory->CreateTextGeometry(&p_text_geometry);
 	}
 
+	// get the counters for what is currently recorded in the draw list
+	draw_list_stats get_stats() const
+	{
+		return { primitive_count, vertices.size() + precise_vertices.size(), indices.size(), batch_list.size(), batch_list.size() + glyph_batches.size(), allocation_count, culled_count };
+	}
+
+	// push a clip rect, it gets intersected with the current clip rect and applies to everything recorded until it is popped
+	void push_clip_rect(const region& clip);
+
+	// pop the last pushed clip rect, every pop has to match a push
+	void pop_clip_rect();
+
+	// get the current clip rect, this is the viewport when no clip rect is pushed
+	const region& get_clip_rect() const;
+
+	// returns true if a clip rect is pushed
+	bool is_clipped() const;
+
+	// set the region that is used when no clip rect is pushed
+	void set_viewport(const region& new_viewport);
+
+	// reserve vertex_count vertices for a primitive directly inside the draw list and return them to be written to
+	// the span is only valid until the next primitive gets reserved, Ty is vertex or precise_vertex
+	template <typename Ty = vertex>
+	std::span<Ty> prim_reserve(size_t vertex_count, D3D_PRIMITIVE_TOPOLOGY type);
+
+	// convert the last reserved primitive to indexed triangles, this gets done automatically by the next reserve and by the renderer
+	void finish_primitive();
+
+	// start copying everything recorded from now on into a geometry cache
+	void begin_capture();
+
+	// copy everything recorded since begin_capture() into cache, the geometry stays in the draw list as well
+	void end_capture(geometry_cache& cache);
+
+	// returns true between begin_capture() and end_capture()
+	bool is_capturing() const;
+
+	// append cached geometry, its batches merge with the open batch like recorded primitives would
+	void add_cached(const geometry_cache& cache);
+
+	// move everything recorded in other to the end of this list and clear other
+	void splice(draw_list& other);
+
+	// width in pixels that line primitives get expanded to
+	static constexpr float line_thickness = 1.f;
+
+	// returns true if the topology can be converted to indexed triangles
+	static bool is_supported_topology(D3D_PRIMITIVE_TOPOLOGY type);
+
+	// amount of vertices a primitive will take up once it is converted to indexed triangles
+	static size_t calc_vertex_count(size_t vertex_count, D3D_PRIMITIVE_TOPOLOGY type);
+
+	// amount of indices a primitive will take up once it is converted to indexed triangles
+	static size_t calc_index_count(size_t vertex_count, D3D_PRIMITIVE_TOPOLOGY type);
+
 	~draw_list()
 	{
 		safe_release(p_text_geometry);
 	}
 
 private:
+	// a reserved primitive whose indices have not been built yet
+	struct pending_primitive
+	{
+		D3D_PRIMITIVE_TOPOLOGY type;
+		vertex_format format;
+		size_t base;
+		size_t vertex_count;
+	};
+
+	// draw list sizes when a capture started
+	struct capture_marker
+	{
+		size_t vertex_count;
+		size_t precise_vertex_count;
+		size_t index_count;
+		size_t batch_count;
+		size_t batch_index_count; // index count of the open batch, indices recorded after this may have been merged into it
+		size_t glyph_count;
+		size_t glyph_batch_count;
+		size_t glyph_batch_glyph_count; // glyph count of the open glyph batch, like batch_index_count
+		size_t primitive_count;
+		size_t placeholder_run_count;
+	};
+
 	std::vector<vertex> vertices;
+	std::vector<precise_vertex> precise_vertices;
+	std::vector<draw_index> indices;
 	std::vector<batch> batch_list;
+	std::vector<FW1_GLYPHVERTEX> glyphs; // glyphs get moved into the text geometry when the list is submitted
+	std::vector<glyph_batch> glyph_batches;
+	std::vector<region> clip_stack;
+	region viewport;
+	size_t primitive_count;
+	size_t allocation_count;
+	size_t culled_count;
+	size_t placeholder_run_count; // glyph runs with placeholder glyphs recorded, so a capture can tell if it has any
+	pending_primitive pending;
+	capture_marker capture_start;
+	bool capturing;
 	IFW1TextGeometry* p_text_geometry;
+
+	// get the vertex storage for a vertex type
+	template <typename Ty>
+	std::vector<Ty>& get_vertices();
+
+	// make sure storage can hold size elements, counts every time it has to grow
+	template <typename Ty>
+	void reserve_storage(std::vector<Ty>& storage, size_t size);
+
+	// build the indices of the pending primitive, lines get expanded to quads in place
+	template <typename Ty>
+	void build_indices();
+
+	// overwrite 4 vertices at index with a quad of line_thickness width from start to end
+	template <typename Ty>
+	void set_line_quad(std::vector<Ty>& vertices, size_t index, Ty start, Ty end);
+
+	// add indices to the current batch, a new batch is started when the vertex format or clip rect changes
+	void add_indices(vertex_format format, size_t index_count);
+
+	// add indices to the last batch if it has the same vertex format and clip rect, else start a new batch
+	void append_batch(vertex_format format, const region& clip, size_t index_count);
+
+	// add glyphs to the last glyph batch if it has the same clip rect, else start a new glyph batch
+	void append_glyph_batch(const region& clip, size_t glyph_count);
+
+	// append geometry whose indices start at 0 for each vertex format, indices get rebased onto the end of this list
+	void append(const std::vector<vertex>& other_vertices, const std::vector<precise_vertex>& other_precise_vertices, const std::vector<draw_index>& other_indices, const std::vector<batch>& other_batches, const std::vector<FW1_GLYPHVERTEX>& other_glyphs, const std::vector<glyph_batch>& other_glyph_batches);
+};
+
+// a dynamic gpu buffer that gets written to like a ring with D3D11_MAP_WRITE_NO_OVERWRITE
+// it only discards when the ring wraps, and grows when a whole frame does not fit so the frame still goes out in one upload
+class ring_buffer
+{
+public:
+	ring_buffer(UINT bind_flags, size_t element_size, size_t capacity);
+	~ring_buffer();
+
+	// create the gpu buffer with the current capacity
+	HRESULT create(ID3D11Device* p_device);
+
+	// copy count elements into the ring, offset receives the element offset they were written at
+	HRESULT upload(ID3D11Device* p_device, ID3D11DeviceContext* p_device_context, const void* p_data, size_t count, size_t& offset);
+
+	ID3D11Buffer* get() const;
+
+	// capacity of the buffer in elements
+	size_t get_capacity() const;
+
+private:
+	ID3D11Buffer* p_buffer;
+	UINT bind_flags;
+	size_t element_size;
+	size_t capacity;
+	size_t position;
+};
+
+// a laid out glyph run
+struct glyph_run
+{
+	std::vector<FW1_GLYPHVERTEX> glyphs;
+	bool has_placeholders; // some glyphs were still being rasterized and use the font's default glyph for now
+};
+
+// shared so a run that gets evicted stays alive until the thread stamping it is done
+using glyph_run_ptr = std::shared_ptr<const glyph_run>;
+
+// caches laid out glyph runs so text that does not change skips the DirectWrite layout pass
+// runs are stored relative to the whole pixel part of the layout rect origin, the least recently used runs get evicted once memory_cap is reached
+class text_layout_cache
+{
+public:
+	// everything that changes how a string gets laid out, text and font only view the strings
+	struct key
+	{
+		std::wstring_view text;
+		uint32_t font_index;
+		uint32_t flags;
+		vec2 rect_size;
+		vec2 origin_fraction; // glyph positions get rounded to whole pixels, so the sub pixel part of the origin changes the layout
+
+		bool operator==(const key& other) const;
+	};
+
+	text_layout_cache(size_t memory_cap);
+
+	// get the cached glyph run for a key and mark it as recently used, nullptr if it is not cached
+	glyph_run_ptr find(const key& layout_key);
+
+	// cache a glyph run, least recently used runs get evicted until it fits under the memory cap
+	glyph_run_ptr insert(const key& layout_key, glyph_run&& run);
+
+	// drop every cached run, needed whenever the glyph atlas the runs index into goes away
+	void clear();
+
+	// drop only the runs with placeholder glyphs, needed when glyphs rasterized in the background got inserted
+	void evict_placeholder_runs();
+
+	// set the amount of bytes the cache tries to stay under, evicts right away if needed
+	void set_memory_cap(size_t new_memory_cap);
+
+	text_cache_stats get_stats() const;
+
+private:
+	// a cached run, the key views the text owned by the entry
+	struct entry
+	{
+		std::wstring text;
+		key layout_key;
+		glyph_run_ptr glyphs;
+		size_t memory;
+	};
+
+	struct key_hash
+	{
+		size_t operator()(const key& layout_key) const;
+	};
+
+	std::list<entry> entries; // most recently used entry first
+	std::unordered_map<key, std::list<entry>::iterator, key_hash> lookup;
+	size_t memory_cap;
+	size_t memory_used;
+	size_t hit_count;
+	size_t miss_count;
+	size_t eviction_count;
+
+	// drop least recently used entries until memory_used + reserve fits under the cap
+	void evict(size_t reserve);
 };
 
 // provides a directx api to easily render primitives
@@ -59,9 +362,40 @@ public:
 	renderer();
 	~renderer();
 
-	// submits the draw list to the gpu for rendering
+	// submits the draw list to the gpu for rendering, if needs_redraw() is false the draw list is dropped and nothing is presented
 	void draw();
 
+	// flag the next frame as changed so it gets presented
+	void mark_dirty();
+
+	// check if the next frame has to be recorded and presented, true if it was marked dirty, glyphs are still being rasterized or the max idle interval has passed
+	bool needs_redraw() const;
+
+	// set the longest time in milliseconds a frame may be skipped for, 0 presents every frame (default)
+	void set_max_idle_interval(float milliseconds);
+
+	// get the amount of frames draw() skipped because nothing changed
+	size_t get_idle_frame_count() const;
+
+	// start capturing everything recorded from now on, it still gets drawn this frame
+	void begin_geometry_capture();
+
+	// stop capturing and copy the captured geometry into cache so it can be added again in later frames
+	void end_geometry_capture(geometry_cache& cache);
+
+	// record everything the calling thread adds into p_list instead of the frame's draw list, nullptr goes back to the frame's draw list
+	// threads with their own draw list can record at the same time, text and circle lookups are shared and take a lock
+	void set_thread_draw_list(draw_list* p_list);
+
+	// move a thread's draw list to the end of the frame's draw list, lists have to be spliced in the order they should be drawn
+	// must not be called while another thread is recording into list
+	void splice_draw_list(draw_list& list);
+
+	// add geometry captured in an earlier frame, returns false without adding anything if cache is empty or stale
+	// caches go stale when the glyph atlas they reference is recreated or evicts glyphs, the geometry has to be recorded again then
+	// caches with placeholder glyphs also go stale once glyphs rasterized in the background are inserted
+	bool add_geometry(const geometry_cache& cache);
+
 	// initialize renderer onto a window 
 	void initialize(HWND hwnd, const color& render_target_color = {}, const std::wstring& font_family = L"Consolas");
 
@@ -77,14 +411,14 @@ public:
 	// adds a connected line from passed in points
 	void add_polyline(const vec2* points, size_t size, const color& color);
 
-	// adds a multicolored line from start to end
-	void add_line_multicolor(const vec2& start, const vec2& end, const color& start_color, const color& end_color);
+	// adds a multicolored line from start to end, precise_colors records full float colors instead of 8 bit colors
+	void add_line_multicolor(const vec2& start, const vec2& end, const color& start_color, const color& end_color, bool precise_colors = false);
 	
 	// add a rectangle 
 	void add_rect_filled(const vec2& top_left, const vec2& size, const color& color);
 	
-	// add a multicolored rectangle
-	void add_rect_filled_multicolor(const vec2& top_left, const vec2& size, const color& top_left_color, const color& top_right_color, const color& bottom_left_color, const color& bottom_right_color);
+	// add a multicolored rectangle, precise_colors records full float colors instead of 8 bit colors for gradients that need it
+	void add_rect_filled_multicolor(const vec2& top_left, const vec2& size, const color& top_left_color, const color& top_right_color, const color& bottom_left_color, const color& bottom_right_color, bool precise_colors = false);
 	
 	// add triangle
 	void add_triangle(const vec2& p1, const vec2& p2, const vec2& p3, const color& color);
@@ -93,16 +427,28 @@ public:
 	void add_triangle_filled(const vec2& p1, const vec2& p2, const vec2& p3, const color& color);
 	
 	// add a multicolored triangle, vertices get arranged to clockwise order so colors might not be on expected points
-	void add_triangle_filled_multicolor(const vec2& p1, const vec2& p2, const vec2& p3, const color& p1_color, const color& p2_color, const color& p3_color);
+	void add_triangle_filled_multicolor(const vec2& p1, const vec2& p2, const vec2& p3, const color& p1_color, const color& p2_color, const color& p3_color, bool precise_colors = false);
 	
-	// add a circle, more segments means smoother looking circle
-	void add_circle(const vec2& middle, float radius, const color& color, size_t segments);
+	// add a circle, more segments means smoother looking circle, 0 segments picks a count from the radius
+	void add_circle(const vec2& middle, float radius, const color& color, size_t segments = 0);
 
 	// add a circle within a region, anything outside of the region will be invisible
-	void add_clipped_circle(const region& region, const vec2& middle, float radius, const color& color, size_t segments);
+	void add_clipped_circle(const region& region, const vec2& middle, float radius, const color& color, size_t segments = 0);
 	
 	// add a filled circle
-	void add_circle_filled(const vec2& middle, float radius, const color& box_color, size_t segments);
+	void add_circle_filled(const vec2& middle, float radius, const color& box_color, size_t segments = 0);
+
+	// add an arc from start_angle to end_angle in radians, segments is the resolution of the full circle the arc is taken from
+	void add_arc(const vec2& middle, float radius, float start_angle, float end_angle, const color& color, size_t segments = 0);
+
+	// set how far in pixels automatic circle segment counts are allowed to deviate from a true circle
+	void set_circle_max_error(float max_error);
+
+	// clip everything added after this to top_left and size (intersected with the current clip rect) until pop_clip_rect is called
+	void push_clip_rect(const vec2& top_left, const vec2& size);
+
+	// restore the clip rect from before the last push_clip_rect
+	void pop_clip_rect();
 
 	// add a thin frame made out of rects
 	void add_frame(const vec2& top_left, const vec2& size, float thickness, const color& frame_color);
@@ -116,20 +462,48 @@ public:
 	// add a frame with a shadow behind it
 	void add_outlined_frame(const vec2& top_left, const vec2& size, float thickness, float outline_thickness, const color& color_, const color& outline_color);
 
+	// get a handle to a font, every family, size and weight combination only gets created once
+	font_handle create_font(const std::wstring& family, float size, DWRITE_FONT_WEIGHT weight = DWRITE_FONT_WEIGHT_NORMAL);
+
+	// get a handle to the renderer font family at a size, the text functions taking a font size use this
+	font_handle get_font(float size);
+
 	// add text, top_left and size are for the text bounding box, see text_flags enum for flags
 	void add_text(const vec2& top_left, const vec2& size, const std::wstring& text, const color& color, float font_size, text_align flags = text_align::left_top);
+	void add_text(const vec2& top_left, const vec2& size, const std::wstring& text, const color& color, font_handle text_font, text_align flags = text_align::left_top);
 
 	// add text with background around the smallest rect containing the text
 	void add_text_with_bg(const vec2& top_left, const vec2& size, const std::wstring& text, const color& text_color, const color& bg_color, float font_size, text_align text_flags = text_align::left_top);
+	void add_text_with_bg(const vec2& top_left, const vec2& size, const std::wstring& text, const color& text_color, const color& bg_color, font_handle text_font, text_align text_flags = text_align::left_top);
 
-	// add outlined text, this is not done in a good way so it could affect performance
+	// add outlined text, the text is laid out once and its glyphs are stamped around it for the outline
 	void add_outlined_text(const vec2& top_left, const vec2& size, const std::wstring& text, const color& text_color, const color& outline_color, float font_size, float outline_size = 1.f, text_align text_flags = text_align::left_top);
+	void add_outlined_text(const vec2& top_left, const vec2& size, const std::wstring& text, const color& text_color, const color& outline_color, font_handle text_font, float outline_size = 1.f, text_align text_flags = text_align::left_top);
 
-	// add outlined text with a background, this is not done in a good way so it could affect performance
+	// add outlined text with a background
 	void add_outlined_text_with_bg(const vec2& top_left, const vec2& size, const std::wstring& text, const color& text_color, const color& outline_color, const color& bg_color, float font_size, float shadow_size = 1.f, text_align text_flags = text_align::left_top);
+	void add_outlined_text_with_bg(const vec2& top_left, const vec2& size, const std::wstring& text, const color& text_color, const color& outline_color, const color& bg_color, font_handle text_font, float shadow_size = 1.f, text_align text_flags = text_align::left_top);
 
 	// see how much space text will take up, returns the height and width text will take up
 	vec2 measure_text(const std::wstring& text, float text_size);
+	vec2 measure_text(const std::wstring& text, font_handle text_font);
+
+	// reserve vertices for a custom primitive directly in the draw list and write them into the returned span
+	// the span is only valid until the next primitive is added, Ty is vertex or precise_vertex
+	template <typename Ty = vertex>
+	std::span<Ty> prim_reserve(size_t vertex_count, D3D_PRIMITIVE_TOPOLOGY type);
+
+	// get the draw list counters of the last submitted frame
+	draw_list_stats get_last_frame_stats() const;
+
+	// set the amount of memory in bytes laid out text is allowed to be cached in
+	void set_text_cache_memory_cap(size_t memory_cap);
+
+	// get the text layout cache counters
+	text_cache_stats get_text_cache_stats() const;
+
+	// rasterize glyphs missing from the atlas on worker threads, text uses a placeholder glyph until they are ready
+	void set_async_glyphs(bool enabled);
 
 private:
 	bool initialized;
@@ -139,26 +513,96 @@ private:
 	ID3D11DeviceContext*	 p_device_context; // d3d device context ptr
 	ID3D11RenderTargetView*  p_backbuffer;     // backbuffer ptr
 	ID3D11InputLayout*		 p_layout;         // layout ptr
+	ID3D11InputLayout*		 p_precise_layout; // precise vertex layout ptr
 	ID3D11BlendState*	     p_blend_state;    // blend state ptr
 	ID3D11DepthStencilState* p_depth_stencil;  // depth stencil ptr
 	ID3D11VertexShader*		 p_vertex_shader;  // vertex shader ptr
 	ID3D11PixelShader*		 p_pixel_shader;   // pixel shader ptr
-	ID3D11Buffer*			 p_vertex_buffer;  // vertex buffer ptr
 	ID3D11Buffer*			 p_screen_projection_buffer; // screen projection buffer ptr
+
+	ring_buffer				 vertex_buffer;			// vertex upload ring
+	ring_buffer				 precise_vertex_buffer; // precise vertex upload ring
+	ring_buffer				 index_buffer;			// index upload ring
+							 
+	ID3D11RasterizerState*	 p_rasterizer_state; // rasterizer state ptr, has scissor testing enabled for clip rects
 							 
 	IFW1Factory*			 p_font_factory;   // font factory ptr
 	IFW1FontWrapper*		 p_font_wrapper;   // font wrapper ptr
-
-	draw_list default_draw_list; // default draw list, we should only need 1 draw list. In the future we could add more
+	IFW1GlyphAtlas*			 p_glyph_atlas;    // glyph atlas ptr, used to find glyph bounds for clipping
+	IFW1GlyphProvider*		 p_glyph_provider; // glyph provider ptr, evicts glyphs that have not been drawn for a while
+	IFW1TextGeometry*		 p_scratch_text_geometry; // text gets laid out in here first when it needs to be clipped
+	IDWriteFactory*			 p_dwrite_factory; // directwrite factory ptr, used to create text formats and layouts
+
+	draw_list default_draw_list; // draw list of the frame, lists recorded on other threads get spliced into it before it is submitted
+	draw_list_stats last_frame_stats;
+	bool frame_dirty;			 // something changed since the last present
+	float max_idle_interval;	 // longest time in milliseconds between presents, 0 presents every frame
+	std::chrono::steady_clock::time_point last_present_time;
+	size_t idle_frame_count;	 // frames skipped by draw() because nothing changed
+	uint32_t geometry_generation; // bumped when captured geometry can no longer be added
+	uint32_t placeholder_generation; // bumped when captured geometry with placeholder glyphs can no longer be added
+	bool async_glyphs;			 // new glyphs are rasterized on worker threads
+	mutable std::recursive_mutex text_mutex; // guards fonts and the text cache while threads record text, glyph runs are stamped outside of it
+	std::mutex circle_table_mutex; // guards the circle table caches while threads record circles
+
+	inline static thread_local draw_list* p_thread_draw_list = nullptr; // draw list the calling thread records into, nullptr for the frame's draw list
+	text_layout_cache text_cache; // glyph runs of recently drawn text
+	std::vector<font_entry> fonts; // every created font, font_handle indexes into this
+	std::unordered_map<float, font_handle> default_fonts; // renderer font family by size
+	std::unordered_map<size_t, circle_table> circle_tables;		   // unit circles for outlines and arcs by segment count
+	std::unordered_map<size_t, circle_table> filled_circle_tables; // unit circles in triangle strip order by segment count
+	float circle_max_error;
 	DirectX::XMMATRIX screen_projection;
 	color render_target_color;
 	std::wstring font;
 
-	// add a vertex to the draw list
-	void add_vertex(const vertex& vertex, const D3D_PRIMITIVE_TOPOLOGY type);
+	// get the draw list the calling thread records into
+	draw_list& get_draw_list();
+
+	// get the segment count to use for a circle, 0 segments picks one from the radius
+	size_t resolve_circle_segments(float radius, size_t segments) const;
+
+	// get the cached unit circle for a segment count, filled circles are stored in triangle strip order
+	const circle_table& get_circle_table(size_t segments, bool filled);
+
+	// trim an axis aligned rect to the current clip rect, returns false if nothing is left of it
+	bool clip_rect(vec2& top_left, vec2& size);
+
+	// returns false and counts the cull if bounds are entirely outside of the current clip rect
+	bool is_visible(const region& bounds);
+
+	// get the glyph run for text from the text cache, it gets laid out and cached on a miss
+	// text_mutex is only held for the lookup, and for the layout on a miss
+	glyph_run_ptr get_text_layout(const std::wstring& text, font_handle text_font, const FW1_RECTF& rect, uint32_t flags);
+
+	// create a DirectWrite layout for text in a font with the same settings FW1 applies for flags, nullptr on failure
+	IDWriteTextLayout* create_text_layout(const std::wstring& text, font_handle text_font, const FW1_RECTF& rect, uint32_t flags);
+
+	// measure the layout box text takes up inside layout_rect, the advances of every character including trailing spaces by the line height
+	// single lines are measured from cached advances and only fall back to DirectWrite if that is not possible, both give the same box
+	FW1_RECTF measure_string(const std::wstring& text, font_handle text_font, const FW1_RECTF& layout_rect, uint32_t flags);
+
+	// sum the advances of a single line of text in design units, trailing_width is the part of width taken up by trailing spaces
+	// returns false if it needs a real layout (control characters, surrogates, missing glyphs)
+	bool measure_single_line(font_entry& entry, const std::wstring& text, float& width, float& trailing_width);
+
+	// get the design unit advance of a character, 0 if the font has no glyph for it
+	float get_glyph_advance(font_entry& entry, wchar_t character);
+
+	// add text to the frame text geometry, glyphs outside of the current clip rect are culled
+	void analyze_text(const std::wstring& text, font_handle text_font, const FW1_RECTF& rect, uint32_t abgr, uint32_t flags);
+
+	// add a cached glyph run translated to origin in one color, glyphs outside of the current clip rect are culled
+	void add_glyph_run(const glyph_run& run, const vec2& origin, uint32_t abgr);
+
+	// bind the input layout and vertex buffer for a vertex format
+	void bind_vertex_format(vertex_format format);
+
+	// upload the default draw list into the ring buffers and submit its batches
+	void submit_draw_list();
 
-	// adds multiple vertices of the same typr to the defualt draw list
-	void add_vertices(vertex* p_vertices, const size_t vertex_count, const D3D_PRIMITIVE_TOPOLOGY type);
+	// draw the default draw list's glyphs, one DrawGeometry call per glyph batch
+	void submit_glyphs();
 
 	// process errors coming from the renderer
 	void handle_error(const char* );
@@ -170,9 +614,11 @@ private:
 	void setup_shaders();
 	void setup_input_layout();
 	void setup_vertex_buffer();
+	void setup_index_buffer();
 	void setup_blend_state();
 	void setup_rasterizer_state();
 	void setup_depth_stencil_state();
 	void setup_screen_projection();
 	void setup_font_renderer(std::wstring font);
+	void setup_font_metrics(font_entry& entry);
 };
\ No newline at end of file
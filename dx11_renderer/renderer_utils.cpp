@@ -1,5 +1,8 @@
 #include "renderer_utils.h"
 
+#include <algorithm>
+#include <xmmintrin.h>
+
 //
 // vec2 definitions
 //
@@ -120,6 +123,11 @@ std::string vec3::to_string() const
 // region definition
 //
 
+bool region::operator==(const region& other) const
+{
+	return top_left == other.top_left && size == other.size;
+}
+
 bool region::is_within(const vec2& other) const
 {
 	return other.x >= top_left.x
@@ -128,6 +136,22 @@ bool region::is_within(const vec2& other) const
 		&& other.y <= top_left.y + size.y;
 }
 
+bool region::intersects(const region& other) const
+{
+	return top_left.x < other.top_left.x + other.size.x
+		&& top_left.y < other.top_left.y + other.size.y
+		&& other.top_left.x < top_left.x + size.x
+		&& other.top_left.y < top_left.y + size.y;
+}
+
+region region::intersect(const region& other) const
+{
+	vec2 low{ (std::max)(top_left.x, other.top_left.x), (std::max)(top_left.y, other.top_left.y) };
+	vec2 high{ (std::min)(top_left.x + size.x, other.top_left.x + other.size.x), (std::min)(top_left.y + size.y, other.top_left.y + other.size.y) };
+
+	return { low, { (std::max)(high.x - low.x, 0.f), (std::max)(high.y - low.y, 0.f) } };
+}
+
 //
 // color definitions
 //
@@ -159,6 +183,16 @@ float& color::operator[](int index)
 	if (index == 3) return a;
 }
 
+bool color::operator==(const color& other) const
+{
+	return r == other.r && g == other.g && b == other.b && a == other.a;
+}
+
+color color::lerp(const color& other, float t) const
+{
+	return { r + (other.r - r) * t, g + (other.g - g) * t, b + (other.b - b) * t, a + (other.a - a) * t };
+}
+
 uint32_t color::to_hex_abgr() const
 {
 	uint32_t hex{};
@@ -329,31 +363,78 @@ color hsv::to_rgb() const
 //
 
 vertex::vertex() :
+	x(0.f), y(0.f),
+	abgr(0)
+{ }
+
+vertex::vertex(float x, float y, uint32_t abgr) :
+	x(x), y(y),
+	abgr(abgr)
+{ }
+
+vertex::vertex(const vec2& pos, const color& rgba) :
+	x(pos.x), y(pos.y),
+	abgr(rgba.to_hex_abgr())
+{ }
+
+vertex::vertex(float x, float y, const color& rgba) :
+	x(x), y(y),
+	abgr(rgba.to_hex_abgr())
+{ }
+
+void vertex::set_color(const color& new_color)
+{
+	abgr = new_color.to_hex_abgr();
+}
+
+void vertex::operator*=(float scalar)
+{
+	x *= scalar;
+	y *= scalar;
+}
+
+void vertex::operator+=(float addition)
+{
+	x += addition;
+	y += addition;
+}
+
+void vertex::operator+=(const vec2& add)
+{
+	x += add.x;
+	y += add.y;
+}
+
+//
+// precise vertex definitions
+//
+
+precise_vertex::precise_vertex() :
 	x(0.f), y(0.f), z(0.f),
 	r(0.f), g(0.f), b(0.f), a(0.f)
 { }
 
-vertex::vertex(float x, float y, float z, float r, float g, float b, float a) :
+precise_vertex::precise_vertex(float x, float y, float z, float r, float g, float b, float a) :
 	x(x), y(y), z(z),
 	r(r), g(g), b(b), a(a)
 { }
 
-vertex::vertex(const vec2& pos, const color& rgba) :
+precise_vertex::precise_vertex(const vec2& pos, const color& rgba) :
 	x(pos.x), y(pos.y), z(0.f),
 	r(rgba.r), g(rgba.g), b(rgba.b), a(rgba.a)
 { }
 
-vertex::vertex(const vec3& pos, const color& rgba) :
+precise_vertex::precise_vertex(const vec3& pos, const color& rgba) :
 	x(pos.x), y(pos.y), z(pos.z),
 	r(rgba.r), g(rgba.g), b(rgba.b), a(rgba.a)
 { }
 
-vertex::vertex(float x, float y, float z, const color& rgba) :
+precise_vertex::precise_vertex(float x, float y, float z, const color& rgba) :
 	x(x), y(y), z(z),
 	r(rgba.r), g(rgba.g), b(rgba.b), a(rgba.a)
 { }
 
-void vertex::set_color(const color& new_color)
+void precise_vertex::set_color(const color& new_color)
 {
 	r = new_color.r;
 	g = new_color.g;
@@ -361,19 +442,19 @@ void vertex::set_color(const color& new_color)
 	a = new_color.a;
 }
 
-void vertex::operator*=(float scalar)
+void precise_vertex::operator*=(float scalar)
 {
 	x *= scalar;
 	y *= scalar;
 }
 
-void vertex::operator+=(float addition)
+void precise_vertex::operator+=(float addition)
 {
 	x += addition;
 	y += addition;
 }
 
-void vertex::operator+=(const vec2& add)
+void precise_vertex::operator+=(const vec2& add)
 {
 	x += add.x;
 	y += add.y;
@@ -383,7 +464,74 @@ void vertex::operator+=(const vec2& add)
 // batch definitions
 //
 
-batch::batch(D3D_PRIMITIVE_TOPOLOGY type, size_t vertex_count) :
-	type(type),
-	vertex_count(vertex_count)
-{ }
\ No newline at end of file
+batch::batch(vertex_format format, const region& clip, size_t index_count) :
+	format(format),
+	clip(clip),
+	index_count(index_count)
+{ }
+
+glyph_batch::glyph_batch(const region& clip, size_t glyph_count) :
+	clip(clip),
+	glyph_count(glyph_count)
+{ }
+
+//
+// circle definitions
+//
+
+size_t calc_circle_segments(float radius, float max_error)
+{
+	if (radius <= max_error)
+		return 4;
+
+	// the furthest a segment gets from the circle is radius * (1 - cos(pi / segments))
+	auto segments = static_cast<size_t>(std::ceil(PI / std::acos(1.f - max_error / radius)));
+
+	// round up to a multiple of 4 so only a small set of unit circles ever gets cached
+	segments = (segments + 3) & ~static_cast<size_t>(3);
+
+	return std::clamp(segments, static_cast<size_t>(4), static_cast<size_t>(MAX_AUTO_CIRCLE_SEGMENTS));
+}
+
+void transform_unit_circle(const float* p_unit_x, const float* p_unit_y, size_t count, const vec2& middle, float radius, float rotation_cos, float rotation_sin, uint32_t abgr, vertex* p_out)
+{
+	const float scaled_cos = radius * rotation_cos;
+	const float scaled_sin = radius * rotation_sin;
+
+	const __m128 middle_x = _mm_set1_ps(middle.x);
+	const __m128 middle_y = _mm_set1_ps(middle.y);
+	const __m128 cos_4 = _mm_set1_ps(scaled_cos);
+	const __m128 sin_4 = _mm_set1_ps(scaled_sin);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 unit_x = _mm_loadu_ps(p_unit_x + i);
+		const __m128 unit_y = _mm_loadu_ps(p_unit_y + i);
+
+		const __m128 x = _mm_add_ps(middle_x, _mm_sub_ps(_mm_mul_ps(unit_x, cos_4), _mm_mul_ps(unit_y, sin_4)));
+		const __m128 y = _mm_add_ps(middle_y, _mm_add_ps(_mm_mul_ps(unit_x, sin_4), _mm_mul_ps(unit_y, cos_4)));
+
+		// interleave into x0 y0 x1 y1 and x2 y2 x3 y3, then store each pair into its vertex
+		const __m128 low = _mm_unpacklo_ps(x, y);
+		const __m128 high = _mm_unpackhi_ps(x, y);
+
+		_mm_storel_pi(reinterpret_cast<__m64*>(&p_out[i].x), low);
+		_mm_storeh_pi(reinterpret_cast<__m64*>(&p_out[i + 1].x), low);
+		_mm_storel_pi(reinterpret_cast<__m64*>(&p_out[i + 2].x), high);
+		_mm_storeh_pi(reinterpret_cast<__m64*>(&p_out[i + 3].x), high);
+
+		p_out[i].abgr = abgr;
+		p_out[i + 1].abgr = abgr;
+		p_out[i + 2].abgr = abgr;
+		p_out[i + 3].abgr = abgr;
+	}
+
+	// remaining points
+	for (; i < count; ++i)
+	{
+		p_out[i].x = middle.x + p_unit_x[i] * scaled_cos - p_unit_y[i] * scaled_sin;
+		p_out[i].y = middle.y + p_unit_x[i] * scaled_sin + p_unit_y[i] * scaled_cos;
+		p_out[i].abgr = abgr;
+	}
+}
@@ -1,12 +1,22 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <unordered_map>
 #include <cmath>
+#include <cstdint>
 
 #include "../FW1FontWrapper/Source/FW1FontWrapper.h"
 
 #define PI 3.141592654f
-#define MAX_DRAW_LIST_VERTICES 0x10000
+#define INITIAL_DRAW_LIST_VERTICES 0x10000
+#define INITIAL_DRAW_LIST_INDICES (INITIAL_DRAW_LIST_VERTICES * 3)
+#define INITIAL_DRAW_LIST_PRECISE_VERTICES 0x1000
+#define MAX_CIRCLE_SEGMENTS 0x10000
+#define MAX_AUTO_CIRCLE_SEGMENTS 512
+#define DEFAULT_CIRCLE_MAX_ERROR 0.25f
+#define DEFAULT_TEXT_CACHE_MEMORY_CAP 0x100000
+#define GLYPH_EVICTION_IDLE_FRAMES 300
 
 // struct for 2d position
 struct vec2
@@ -54,7 +64,15 @@ struct region
 	vec2 top_left;
 	vec2 size;
 
+	bool operator==(const region& other) const;
+
 	bool is_within(const vec2& pos) const;
+
+	// returns true if the regions overlap
+	bool intersects(const region& other) const;
+
+	// returns the overlapping part of both regions, size is zero if they do not overlap
+	region intersect(const region& other) const;
 };
 
 struct hsv;
@@ -69,9 +87,13 @@ struct color
 	color(float r, float g, float b, float a);
 	
 	void operator+=(float amount);
+	bool operator==(const color& other) const;
 
 	float& operator[](int index);
 
+	// linearly interpolate towards other, t of 0 returns this color and t of 1 returns other
+	color lerp(const color& other, float t) const;
+
 	// convert float 4 rgba to uint32 hex abgr
 	uint32_t to_hex_abgr() const;
 
@@ -132,21 +154,57 @@ enum class text_align : uint32_t
 	right_bottom	= right  | bottom,
 };
 
-// a struct that contains position and color information that the gpu will process
+// vertex layouts the draw list can record primitives in
+enum class vertex_format : uint8_t
+{
+	packed,  // vertex, float2 position + R8G8B8A8_UNORM color
+	precise, // precise_vertex, float3 position + R32G32B32A32_FLOAT color
+};
+
+// a struct that contains position and color information that the gpu will process, color is packed as abgr so it reads as R8G8B8A8_UNORM
 struct vertex
 {
-	float x, y, z;
-	float r, g, b, a;
+	static constexpr vertex_format format = vertex_format::packed;
+
+	float x, y;
+	uint32_t abgr;
 
 	vertex();
 
-	vertex(float x, float y, float z, float r, float g, float b, float a);
+	vertex(float x, float y, uint32_t abgr);
 
 	vertex(const vec2& pos, const color& rgba);
 
-	vertex(const vec3& pos, const color& rgba);
+	vertex(float x, float y, const color& rgba);
+
+	void set_color(const color& new_color);
+
+	void operator*=(float scalar);
+
+	void operator+=(float addition);
+
+	void operator+=(const vec2& add);
+};
+
+static_assert(sizeof(vertex) == 12, "vertex - packed vertex must be 12 bytes");
+
+// a full float vertex, only used for primitives that opt in to precise colors such as subtle gradients
+struct precise_vertex
+{
+	static constexpr vertex_format format = vertex_format::precise;
+
+	float x, y, z;
+	float r, g, b, a;
+
+	precise_vertex();
+
+	precise_vertex(float x, float y, float z, float r, float g, float b, float a);
 
-	vertex(float x, float y, float z, const color& rgba);
+	precise_vertex(const vec2& pos, const color& rgba);
+
+	precise_vertex(const vec3& pos, const color& rgba);
+
+	precise_vertex(float x, float y, float z, const color& rgba);
 
 	void set_color(const color& new_color);
 
@@ -157,13 +215,75 @@ struct vertex
 	void operator+=(const vec2& add);
 };
 
-// a struct that contains counts and primitive topology type for a vertex or vertices
+// index type used by the draw list index buffer
+using draw_index = uint32_t;
+
+// a range of triangle list indices in one vertex format and clip rect that gets submitted with a single DrawIndexed call
 struct batch
 {
-	D3D_PRIMITIVE_TOPOLOGY type;
-	size_t vertex_count;
+	vertex_format format;
+	region clip;
+	size_t index_count;
+
+	batch(vertex_format format, const region& clip, size_t index_count);
+};
+
+// a range of glyphs recorded under one clip rect, the font wrapper draws it with a single DrawGeometry call clipped to it
+struct glyph_batch
+{
+	region clip;
+	size_t glyph_count;
 
-	batch(D3D_PRIMITIVE_TOPOLOGY type, size_t vertex_count);
+	glyph_batch(const region& clip, size_t glyph_count);
+};
+
+// per frame counters of a draw list, used to check how well primitives are being batched
+struct draw_list_stats
+{
+	size_t primitive_count;	// amount of primitives (rects, lines, circles, ...) recorded
+	size_t vertex_count;	// amount of vertices uploaded to the gpu
+	size_t index_count;		// amount of indices uploaded to the gpu
+	size_t batch_count;		// amount of batches in the batch list
+	size_t draw_call_count;	// amount of draw calls needed to submit the draw list
+	size_t allocation_count;// amount of times draw list storage had to grow, 0 once a frame has reached its steady state
+	size_t culled_count;	// amount of rects, circles and glyphs skipped because they were outside of the clip rect
+};
+
+// design unit metrics of a font, they get scaled by font_size / design_units_per_em so one table serves every font size
+struct font_metrics
+{
+	float design_units_per_em;
+	float line_height;		// ascent + descent + line gap, the height of a single line of text
+	float ascii_advance;	// advance shared by every printable ascii character, 0 if the font is not monospaced
+	std::unordered_map<wchar_t, float> advances; // advances of characters looked up so far, 0 if the font has no glyph for the character
+};
+
+// refers to a font created by renderer::create_font
+struct font_handle
+{
+	uint32_t index;
+};
+
+// a font the renderer has created, the text format is built once and used for every layout in this font
+struct font_entry
+{
+	std::wstring family;
+	float size;
+	DWRITE_FONT_WEIGHT weight;
+	IDWriteTextFormat* p_text_format;
+	IDWriteFontFace* p_font_face; // used to look up glyph advances, nullptr if it could not be opened
+	font_metrics metrics;
+};
+
+// counters of the text layout cache, hits and misses add up over the lifetime of the renderer
+struct text_cache_stats
+{
+	size_t hit_count;		// amount of text layouts that were reused from the cache
+	size_t miss_count;		// amount of text layouts that had to go through DirectWrite
+	size_t eviction_count;	// amount of cached layouts dropped to stay under the memory cap or because their placeholder glyphs got replaced
+	size_t entry_count;		// amount of layouts currently cached
+	size_t memory_used;		// approximate amount of bytes the cached layouts take up
+	size_t memory_cap;		// amount of bytes the cache tries to stay under
 };
 
 // function for safely releasing com object pointers
@@ -185,6 +305,19 @@ inline float calc_theta(size_t vertex_index, size_t total_points)
 	return 2.f * PI * static_cast<float>(vertex_index) / static_cast<float>(total_points);
 }
 
+// unit circle positions for a segment count, x and y are kept in separate arrays so they can be transformed 4 at a time
+struct circle_table
+{
+	std::vector<float> x;
+	std::vector<float> y;
+};
+
+// calculate how many segments a circle of radius pixels needs to stay within max_error pixels of a true circle
+size_t calc_circle_segments(float radius, float max_error);
+
+// rotate, scale and translate count unit circle points straight into vertex memory using sse
+void transform_unit_circle(const float* p_unit_x, const float* p_unit_y, size_t count, const vec2& middle, float radius, float rotation_cos, float rotation_sin, uint32_t abgr, vertex* p_out);
+
 namespace shaders
 {
 	inline uint8_t vertex[] = {
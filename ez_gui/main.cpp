@@ -40,6 +40,8 @@ int main()
     renderer renderer{};
     renderer.initialize(hwnd);
     renderer.set_render_target_color(colors::white);
+    renderer.set_max_idle_interval(1000.f);
+    renderer.set_async_glyphs(true);
     widget::set_renderer(&renderer);
 
     slider_style sldr_style_test{ text_style{12.f, colors::blue}, border_style{1.f, colors::red}, mc_rect{colors::black}, mc_rect{colors::gray} };
@@ -54,27 +56,46 @@ int main()
     globals::widget_lists[0].add_widget(&slider_test);
     globals::widget_lists[0].add_widget(&editor);
 
+    // started once, lists get recorded on them every frame
+    // PARALLEL_DRAW_THREADS is 0 so lists are recorded on this thread, text layout misses take the renderer's text lock and do not scale with threads
+    worker_pool list_workers{ PARALLEL_DRAW_THREADS };
+
     MSG msg;
-    while (TRUE)
+    bool running = true;
+    while (running)
     {
+        // pump every pending window message so input does not back up behind the frame rate
         ZeroMemory(&msg, sizeof(msg));
-        if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+        while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
         {
             if (msg.message == WM_QUIT)
-                break;
+                running = false;
             TranslateMessage(&msg);
             DispatchMessage(&msg);
         }
 
+        if (!running)
+            break;
+
+        // input that did not fit into a full queue would otherwise wait until the next message arrives
+        globals::flush_widget_list_input();
+
         for (auto& widget_list : globals::widget_lists)
-            widget_list.draw_widgets();
+            widget_list.update();
 
         if (GetAsyncKeyState(VK_INSERT) & 0x1)
             globals::widget_lists.front().to_string();
 
-        renderer.draw();
+        // frames where nothing changed are not recorded or presented, the window keeps showing the last one
+        if (renderer.needs_redraw())
+        {
+            globals::draw_widget_lists(list_workers);
+
+            renderer.draw();
+        }
 
-        Sleep(10);
+        // wake up early when input arrives instead of sleeping through it
+        MsgWaitForMultipleObjects(0, nullptr, FALSE, 10, QS_ALLINPUT);
     }
 
     renderer.cleanup();
@@ -9,6 +9,175 @@ owned_widget::owned_widget(std::unique_ptr<widget> p_wdgt, uint32_t owned_styles
 	, owned_styles_idx(owned_styles_idx)
 { }
 
+//
+// widget grid definitions
+//
+
+widget_grid::widget_grid() :
+	cells()
+{ }
+
+void widget_grid::insert(uint32_t idx, const region& bounds)
+{
+	int32_t min_x, min_y, max_x, max_y;
+	get_cell_range(bounds, min_x, min_y, max_x, max_y);
+
+	for (auto y = min_y; y <= max_y; ++y)
+		for (auto x = min_x; x <= max_x; ++x)
+			cells[cell_key(x, y)].push_back(idx);
+}
+
+void widget_grid::erase(uint32_t idx, const region& bounds)
+{
+	int32_t min_x, min_y, max_x, max_y;
+	get_cell_range(bounds, min_x, min_y, max_x, max_y);
+
+	for (auto y = min_y; y <= max_y; ++y)
+	{
+		for (auto x = min_x; x <= max_x; ++x)
+		{
+			auto cell = cells.find(cell_key(x, y));
+			if (cell == cells.end())
+				continue;
+
+			auto& indices = cell->second;
+			indices.erase(std::remove(indices.begin(), indices.end(), idx), indices.end());
+
+			if (indices.empty())
+				cells.erase(cell);
+		}
+	}
+}
+
+void widget_grid::clear()
+{
+	cells.clear();
+}
+
+const std::vector<uint32_t>* widget_grid::query(const vec2& pos) const
+{
+	auto cell = cells.find(cell_key(static_cast<int32_t>(std::floor(pos.x / cell_size)), static_cast<int32_t>(std::floor(pos.y / cell_size))));
+
+	return cell == cells.end() ? nullptr : &cell->second;
+}
+
+void widget_grid::query(const region& bounds, std::vector<uint32_t>& indices) const
+{
+	int32_t min_x, min_y, max_x, max_y;
+	get_cell_range(bounds, min_x, min_y, max_x, max_y);
+
+	for (auto y = min_y; y <= max_y; ++y)
+	{
+		for (auto x = min_x; x <= max_x; ++x)
+		{
+			auto cell = cells.find(cell_key(x, y));
+			if (cell != cells.end())
+				indices.insert(indices.end(), cell->second.begin(), cell->second.end());
+		}
+	}
+}
+
+uint64_t widget_grid::cell_key(int32_t x, int32_t y)
+{
+	return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+}
+
+void widget_grid::get_cell_range(const region& bounds, int32_t& min_x, int32_t& min_y, int32_t& max_x, int32_t& max_y)
+{
+	// widget::contains includes the bottom right edge, so the cell range does too
+	min_x = static_cast<int32_t>(std::floor(bounds.top_left.x / cell_size));
+	min_y = static_cast<int32_t>(std::floor(bounds.top_left.y / cell_size));
+	max_x = static_cast<int32_t>(std::floor((bounds.top_left.x + bounds.size.x) / cell_size));
+	max_y = static_cast<int32_t>(std::floor((bounds.top_left.y + bounds.size.y) / cell_size));
+}
+
+//
+// widget pool definitions
+//
+
+widget_pool::widget_pool(uint32_t sort_key, pool_kind kind) :
+	sort_key(sort_key),
+	kind(kind),
+	indices(),
+	positions(),
+	sizes(),
+	label_positions(),
+	labels(),
+	style_indices(),
+	styles(),
+	floats(),
+	min_values(),
+	ranges(),
+	bools(),
+	geometry()
+{ }
+
+void widget_pool::add_instance(uint32_t idx, widget* p_widget)
+{
+	indices.push_back(idx);
+
+	// generic widgets draw themselves, they have no arrays to fill
+	if (kind == pool_kind::generic)
+		return;
+
+	positions.emplace_back();
+	sizes.emplace_back();
+	label_positions.emplace_back();
+	labels.emplace_back();
+	style_indices.push_back(0);
+
+	if (kind == pool_kind::float_slider)
+	{
+		floats.push_back(nullptr);
+		min_values.push_back(0.f);
+		ranges.push_back(0.f);
+	}
+	else
+		bools.push_back(nullptr);
+
+	gather_instance(indices.size() - 1, p_widget);
+}
+
+bool widget_pool::gather_instance(size_t i, widget* p_widget)
+{
+	auto style_it = std::find(styles.begin(), styles.end(), p_widget->p_style);
+	if (style_it == styles.end())
+		style_it = styles.insert(styles.end(), p_widget->p_style);
+
+	auto style_idx = static_cast<uint32_t>(style_it - styles.begin());
+	auto extent_moved = style_indices[i] != style_idx || labels[i] != p_widget->label || !(label_positions[i] == p_widget->label_pos);
+
+	positions[i] = p_widget->top_left;
+	sizes[i] = p_widget->size;
+	label_positions[i] = p_widget->label_pos;
+	labels[i] = p_widget->label;
+	style_indices[i] = style_idx;
+
+	if (kind == pool_kind::float_slider)
+	{
+		auto p_slider = static_cast<slider<float>*>(p_widget);
+		floats[i] = p_slider->value;
+		min_values[i] = p_slider->min_value;
+		ranges[i] = p_slider->get_range();
+	}
+	else
+		bools[i] = static_cast<checkbox*>(p_widget)->value;
+
+	return extent_moved;
+}
+
+pool_kind widget_pool::get_kind(widget* p_widget)
+{
+	// pools call draw() of the exact type, so widgets derived from these and sliders of other value types keep drawing themselves
+	if (typeid(*p_widget) == typeid(checkbox))
+		return pool_kind::checkbox;
+
+	if (typeid(*p_widget) == typeid(slider<float>))
+		return pool_kind::float_slider;
+
+	return pool_kind::generic;
+}
+
 //
 // widget list definitions
 //
@@ -19,10 +188,20 @@ widget_list::widget_list() :
 	background(),
 	active(true),
 	move_mode(false),
+	dirty(true),
 	widgets(),
 	owned_widgets(),
 	owned_styles(),
-	input_msgs()
+	p_arena(),
+	widget_bounds(),
+	hit_grid(),
+	captured_idx(-1),
+	focused_idx(-1),
+	p_input_msgs(std::make_unique<input_channel>()),
+	last_input_stats(),
+	pooled_draw(false),
+	pools_dirty(true),
+	pools()
 { }
 
 widget_list::widget_list(const vec2& top_left, const vec2& size) :
@@ -31,10 +210,20 @@ widget_list::widget_list(const vec2& top_left, const vec2& size) :
 	background(),
 	active(true),
 	move_mode(false),
+	dirty(true),
 	widgets(),
 	owned_widgets(),
 	owned_styles(),
-	input_msgs()
+	p_arena(),
+	widget_bounds(),
+	hit_grid(),
+	captured_idx(-1),
+	focused_idx(-1),
+	p_input_msgs(std::make_unique<input_channel>()),
+	last_input_stats(),
+	pooled_draw(false),
+	pools_dirty(true),
+	pools()
 { }
 
 widget_list::widget_list(const vec2& top_left, const vec2& size, const mc_rect& background) :
@@ -43,10 +232,20 @@ widget_list::widget_list(const vec2& top_left, const vec2& size, const mc_rect&
 	background(background),
 	active(true),
 	move_mode(false),
+	dirty(true),
 	widgets(),
 	owned_widgets(),
 	owned_styles(),
-	input_msgs()
+	p_arena(),
+	widget_bounds(),
+	hit_grid(),
+	captured_idx(-1),
+	focused_idx(-1),
+	p_input_msgs(std::make_unique<input_channel>()),
+	last_input_stats(),
+	pooled_draw(false),
+	pools_dirty(true),
+	pools()
 { }
 
 widget_list::widget_list(const vec2& top_left, const vec2& size, const mc_rect& background, std::vector<owned_widget> owned_widgets_, std::vector<std::unique_ptr<style>> owned_styles_) :
@@ -55,27 +254,43 @@ widget_list::widget_list(const vec2& top_left, const vec2& size, const mc_rect&
 	background(background),
 	active(true),
 	move_mode(false),
+	dirty(true),
 	widgets(),
 	owned_widgets(std::move(owned_widgets_)),
 	owned_styles(std::move(owned_styles_)),
-	input_msgs()
+	p_arena(),
+	widget_bounds(),
+	hit_grid(),
+	captured_idx(-1),
+	focused_idx(-1),
+	p_input_msgs(std::make_unique<input_channel>()),
+	last_input_stats(),
+	pooled_draw(false),
+	pools_dirty(true),
+	pools()
 { 
 	for (auto& owned_widget : this->owned_widgets)
 	{
 		owned_widget.p_wdgt->set_style(owned_styles[owned_widget.owned_styles_idx].get());
 		widgets.push_back(owned_widget.p_wdgt.get());
 	}
+
+	refresh_widget_bounds();
 }
 
 void widget_list::add_widget(widget* p_widget)
 {
 	widgets.push_back(p_widget);
+	widget_bounds.push_back({ p_widget->top_left, p_widget->size });
+	hit_grid.insert(static_cast<uint32_t>(widgets.size() - 1), widget_bounds.back());
+	dirty = true;
+	pools_dirty = true;
 }
 
 void widget_list::add_widgets(widget* p_widgets, size_t count)
 {
 	for (auto i = 0u; i < count; ++i)
-		widgets.push_back(&p_widgets[i]);
+		add_widget(&p_widgets[i]);
 }
 
 bool widget_list::remove_widget(widget* p_widget)
@@ -85,9 +300,7 @@ bool widget_list::remove_widget(widget* p_widget)
 	if (position == widgets.end())
 		return false;
 	
-	widgets.erase(position);
-
-	return true;
+	return remove_widget(static_cast<uint32_t>(std::distance(widgets.begin(), position)));
 }
 
 bool widget_list::remove_widget(uint32_t idx)
@@ -95,17 +308,34 @@ bool widget_list::remove_widget(uint32_t idx)
 	if (idx < 0 || idx >= widgets.size())
 		return false;
 
+	if (focused_idx == static_cast<int32_t>(idx))
+		set_focus_index(-1);
+	else if (focused_idx > static_cast<int32_t>(idx))
+		focused_idx--;
+
 	widgets.erase(widgets.begin() + idx);
 
+	// every widget after idx moves down in the draw order, so the grid gets rebuilt
+	captured_idx = -1;
+	refresh_widget_bounds();
+	dirty = true;
+
 	return true;
 }
 
 void widget_list::add_input_msg(const widget_input& msg)
 {
-	if (!active)
-		return;
+	p_input_msgs->push(msg);
+}
+
+void widget_list::flush_input_msgs()
+{
+	p_input_msgs->flush();
+}
 
-	input_msgs.push(msg);
+input_stats widget_list::get_input_stats() const
+{
+	return last_input_stats;
 }
 
 bool widget_list::contains(const vec2& pos)
@@ -116,74 +346,454 @@ bool widget_list::contains(const vec2& pos)
 		&& pos.y <= top_left.y + size.y;
 }
 
+widget* widget_list::hit_test(const vec2& pos)
+{
+	auto idx = hit_test_index(pos);
+
+	return idx == -1 ? nullptr : widgets[idx];
+}
+
+void widget_list::mark_style_users_dirty(const void* p_field)
+{
+	if (!p_field)
+		return;
+
+	for (auto widget : widgets)
+	{
+		if (widget->p_style && widget->p_style->contains(p_field))
+		{
+			widget->mark_dirty();
+			dirty = true;
+		}
+	}
+}
+
+void widget_list::refresh_widget_bounds()
+{
+	hit_grid.clear();
+	widget_bounds.clear();
+
+	for (auto i = 0u; i < widgets.size(); ++i)
+	{
+		widget_bounds.push_back({ widgets[i]->top_left, widgets[i]->size });
+		hit_grid.insert(i, widget_bounds.back());
+
+		// the widgets may have been moved, so their cached geometry has to be recorded again
+		widgets[i]->mark_dirty();
+	}
+
+	dirty = true;
+	pools_dirty = true;
+}
+
+void widget_list::set_focus(widget* p_widget)
+{
+	auto position = std::find(widgets.begin(), widgets.end(), p_widget);
+
+	set_focus_index(position == widgets.end() ? -1 : static_cast<int32_t>(std::distance(widgets.begin(), position)));
+}
+
+widget* widget_list::get_focus()
+{
+	return focused_idx == -1 ? nullptr : widgets[focused_idx];
+}
+
+bool widget_list::update()
+{
+	handle_input_msgs();
+
+	// widgets can be moved or resized from code, their bounds decide hit testing and draw layers
+	for (auto i = 0u; i < widgets.size(); ++i)
+		update_widget_bounds(i);
+
+	// bound values can be changed by anything, so every widget compares them to what it last drew
+	// widgets bound to the same value notice on their own, widgets drawn with a style the value is a field of have to be told
+	if (active)
+	{
+		for (auto widget : widgets)
+		{
+			if (widget->value_changed())
+			{
+				globals::mark_style_users_dirty(widget->get_value_ptr());
+				dirty = true;
+			}
+			else if (widget->dirty)
+				dirty = true;
+		}
+	}
+
+	if (dirty)
+		widget::p_renderer->mark_dirty();
+
+	return dirty;
+}
+
 void widget_list::draw_widgets()
 {
+	dirty = false;
+
 	if (!active)
 		return;
 
-	handle_next_input();
-
     widget::p_renderer->add_rect_filled_multicolor(top_left, size, background.tl_clr, background.tr_clr, background.bl_clr, background.br_clr);
 
-	for (auto& widget : widgets)
-		widget->draw();
+	if (!pooled_draw)
+	{
+		for (auto i = 0u; i < widgets.size(); ++i)
+			draw_widget(i);
+
+		return;
+	}
+
+	if (pools_dirty)
+		rebuild_pools();
+
+	for (auto& pool : pools)
+	{
+		if (pool.kind == pool_kind::generic)
+		{
+			for (auto idx : pool.indices)
+				draw_widget(idx);
+		}
+		else
+			draw_pool(pool);
+	}
 }
 
-void widget_list::handle_next_input()
+void widget_list::handle_input_msgs()
 {
-	if (input_msgs.empty())
+	// only drain what is there now, so a producer that keeps pushing can not hold up the frame
+	auto count = p_input_msgs->size();
+	if (count == 0)
 		return;
-	
-	auto& msg = input_msgs.front();
 
+	widget_input msg{ vec2{} };
+	std::optional<widget_input> pending_move;
+	size_t coalesced_count = p_input_msgs->take_coalesced_count();
+	float input_age = 0.f;
+
+	for (auto i = 0u; i < count && p_input_msgs->pop(msg); ++i)
+	{
+		// the first message is the oldest one
+		if (i == 0)
+			input_age = std::chrono::duration<float, std::milli>(input_clock::now() - msg.time).count();
+
+		if (!active)
+			continue;
+
+		// only the latest position of a burst of mouse moves matters, button and key messages stay in order around it
+		if (msg.type == input_type::mouse_move)
+		{
+			if (pending_move)
+			{
+				pending_move->m_pos = msg.m_pos;
+				coalesced_count++;
+			}
+			else
+				pending_move = msg;
+
+			continue;
+		}
+
+		if (pending_move)
+		{
+			handle_input(*pending_move);
+			pending_move.reset();
+		}
+
+		handle_input(msg);
+	}
+
+	if (pending_move)
+		handle_input(*pending_move);
+
+	last_input_stats = { count, coalesced_count, p_input_msgs->take_dropped_count(), input_age };
+}
+
+void widget_list::handle_input(const widget_input& msg)
+{
 	if (msg.type == input_type::mouse_move)
 	{
+		// only the widget that got the lbutton_down can be dragged
+		if (captured_idx == -1 || !widgets[captured_idx]->mouse_info.clicking)
+			return;
+
 		if (move_mode)
 		{
-			for (auto widget : widgets)
-				if (widget->mouse_info.clicking)
-					widget->on_widget_move(msg.m_pos);
+			widgets[captured_idx]->on_widget_move(msg.m_pos);
+			update_widget_bounds(captured_idx);
 		}
 		else
-		{
-			for (auto widget : widgets)
-				if (widget->mouse_info.clicking)
-					widget->on_drag(msg.m_pos);
-		}
+			widgets[captured_idx]->on_drag(msg.m_pos);
+
+		widgets[captured_idx]->mark_dirty();
+		dirty = true;
 	}
 	else if (msg.type == input_type::lbutton_down)
 	{
-		for (auto widget : widgets)
-			if (widget->contains(msg.m_pos))
-				widget->on_lbutton_down(msg.m_pos);
+		captured_idx = hit_test_index(msg.m_pos);
+
+		// clicking anything that does not take keyboard input clears the focus
+		set_focus_index(captured_idx);
+
+		if (captured_idx != -1)
+		{
+			widgets[captured_idx]->on_lbutton_down(msg.m_pos);
+			widgets[captured_idx]->mark_dirty();
+			dirty = true;
+		}
 	}
 	else if (msg.type == input_type::lbutton_up)
 	{
-		for (auto widget : widgets)
+		auto idx = hit_test_index(msg.m_pos);
+
+		if (idx != -1)
 		{
-			if (widget->contains(msg.m_pos))
-				widget->on_lbutton_up(msg.m_pos);
-			else
-				widget->mouse_info.clicking = false;
+			widgets[idx]->on_lbutton_up(msg.m_pos);
+			widgets[idx]->mark_dirty();
+			dirty = true;
+		}
+
+		// the button was released outside of the widget that was clicked
+		if (captured_idx != -1 && captured_idx != idx)
+		{
+			widgets[captured_idx]->mouse_info.clicking = false;
+			widgets[captured_idx]->mark_dirty();
+			dirty = true;
 		}
+
+		captured_idx = -1;
 	}
 	else if (msg.type == input_type::key_press)
 	{
-		for (auto widget : widgets)
-			widget->on_key_down(msg.key);
+		if (msg.key == '\t')
+			focus_next();
+		else if (focused_idx != -1)
+		{
+			widgets[focused_idx]->on_key_down(msg.key);
+			widgets[focused_idx]->mark_dirty();
+			dirty = true;
+		}
 	}
-	
-	input_msgs.pop();
+}
+
+int32_t widget_list::hit_test_index(const vec2& pos)
+{
+	auto p_candidates = hit_grid.query(pos);
+	if (!p_candidates)
+		return -1;
+
+	// widgets are drawn in list order, so the highest index is on top
+	int32_t topmost = -1;
+	for (auto idx : *p_candidates)
+	{
+		if (static_cast<int32_t>(idx) > topmost && widgets[idx]->contains(pos))
+			topmost = static_cast<int32_t>(idx);
+	}
+
+	return topmost;
+}
+
+void widget_list::update_widget_bounds(uint32_t idx)
+{
+	region bounds{ widgets[idx]->top_left, widgets[idx]->size };
+	if (bounds == widget_bounds[idx])
+		return;
+
+	hit_grid.erase(idx, widget_bounds[idx]);
+	hit_grid.insert(idx, bounds);
+	widget_bounds[idx] = bounds;
+	widgets[idx]->mark_dirty();
+	dirty = true;
+	pools_dirty = true;
+}
+
+void widget_list::set_focus_index(int32_t idx)
+{
+	if (idx != -1 && !widgets[idx]->is_focusable())
+		idx = -1;
+
+	if (idx == focused_idx)
+		return;
+
+	if (focused_idx != -1)
+	{
+		widgets[focused_idx]->mouse_info.focused = false;
+		widgets[focused_idx]->mark_dirty();
+	}
+
+	focused_idx = idx;
+
+	if (focused_idx != -1)
+	{
+		widgets[focused_idx]->mouse_info.focused = true;
+		widgets[focused_idx]->mark_dirty();
+	}
+
+	dirty = true;
+}
+
+void widget_list::focus_next()
+{
+	auto count = static_cast<int32_t>(widgets.size());
+
+	for (auto i = 1; i <= count; ++i)
+	{
+		auto idx = (focused_idx + i) % count;
+		if (widgets[idx]->is_focusable())
+		{
+			set_focus_index(idx);
+			return;
+		}
+	}
+}
+
+widget_arena& widget_list::get_arena()
+{
+	if (!p_arena)
+		p_arena = std::make_unique<widget_arena>();
+
+	return *p_arena;
+}
+
+void widget_list::draw_widget(uint32_t idx)
+{
+	auto widget = widgets[idx];
+
+	// clean widgets add the geometry they recorded last time instead of drawing again
+	if (!widget->is_dirty() && widget::p_renderer->add_geometry(widget->geometry))
+		return;
+
+	widget::p_renderer->begin_geometry_capture();
+	widget->draw();
+	widget::p_renderer->end_geometry_capture(widget->geometry);
+
+	widget->clear_dirty();
+}
+
+void widget_list::rebuild_pools()
+{
+	pools.clear();
+
+	std::vector<uint32_t> layers(widgets.size(), 0);
+	std::vector<region> extents(widgets.size());
+	std::vector<uint32_t> neighbours;
+	std::unordered_map<uint32_t, size_t> pool_lookup; // pool index by sort key
+	widget_grid extent_grid;						  // draw extents reach past the widget bounds the hit grid has, labels especially
+
+	for (auto i = 0u; i < widgets.size(); ++i)
+	{
+		// grow by the margin of both widgets, so only the raw extent of the other widget is needed
+		auto extent = widgets[i]->get_draw_extent();
+		region reach{ extent.top_left - layer_margin * 2.f, extent.size + layer_margin * 4.f };
+
+		neighbours.clear();
+		extent_grid.query(reach, neighbours);
+
+		for (auto idx : neighbours)
+		{
+			auto overlap = reach.intersect(extents[idx]);
+			if (overlap.size.x > 0.f && overlap.size.y > 0.f)
+				layers[i] = (std::max)(layers[i], layers[idx] + 1);
+		}
+
+		extents[i] = extent;
+		extent_grid.insert(i, extent);
+
+		auto kind = widget_pool::get_kind(widgets[i]);
+		auto sort_key = layers[i] << 8 | static_cast<uint32_t>(kind);
+
+		auto [lookup, inserted] = pool_lookup.try_emplace(sort_key, pools.size());
+		if (inserted)
+			pools.emplace_back(sort_key, kind);
+
+		pools[lookup->second].add_instance(i, widgets[i]);
+	}
+
+	std::sort(pools.begin(), pools.end(), [](const widget_pool& a, const widget_pool& b) { return a.sort_key < b.sort_key; });
+	pools_dirty = false;
+}
+
+void widget_list::draw_pool(widget_pool& pool)
+{
+	auto changed = false;
+	for (auto i = 0u; i < pool.indices.size(); ++i)
+	{
+		auto p_widget = widgets[pool.indices[i]];
+		if (!p_widget->is_dirty())
+			continue;
+
+		// a widget whose label or style changed can overlap other widgets of its layer now, sort it again next frame
+		if (pool.gather_instance(i, p_widget))
+		{
+			pools_dirty = true;
+			dirty = true;
+		}
+
+		changed = true;
+	}
+
+	if (!changed && widget::p_renderer->add_geometry(pool.geometry))
+		return;
+
+	widget::p_renderer->begin_geometry_capture();
+
+	if (pool.kind == pool_kind::float_slider)
+	{
+		for (auto i = 0u; i < pool.indices.size(); ++i)
+		{
+			auto ratio = pool.floats[i] != nullptr ? (*pool.floats[i] - pool.min_values[i]) / pool.ranges[i] : 0.f;
+			slider<float>::draw_geometry(pool.positions[i], pool.sizes[i], pool.label_positions[i], pool.labels[i], ratio, static_cast<slider_style*>(pool.styles[pool.style_indices[i]]));
+		}
+	}
+	else
+	{
+		for (auto i = 0u; i < pool.indices.size(); ++i)
+			checkbox::draw_geometry(pool.positions[i], pool.sizes[i], pool.label_positions[i], pool.labels[i], *pool.bools[i], static_cast<checkbox_style*>(pool.styles[pool.style_indices[i]]));
+	}
+
+	widget::p_renderer->end_geometry_capture(pool.geometry);
+
+	for (auto idx : pool.indices)
+		widgets[idx]->clear_dirty();
+}
+
+void widget_list::set_pooled_draw(bool pooled)
+{
+	pooled_draw = pooled;
+	pools_dirty = true;
+	dirty = true;
+
+	// pools record into their own caches, so the caches of the widgets are stale after pooled frames
+	for (auto widget : widgets)
+		widget->mark_dirty();
+}
+
+bool widget_list::get_pooled_draw() const
+{
+	return pooled_draw;
 }
 
 void widget_list::set_active(bool active)
 {
 	this->active = active;
+	dirty = true;
+}
+
+bool widget_list::is_active() const
+{
+	return active;
+}
+
+size_t widget_list::get_widget_count() const
+{
+	return widgets.size();
 }
 
 void widget_list::set_move_mode(bool mode)
 {
 	move_mode = mode;
+	dirty = true;
 
 	// if we want to move our widgets, we should deactivate them so they don't respond normally to mouse input
 	for (auto widget : widgets)
@@ -193,6 +803,7 @@ void widget_list::set_move_mode(bool mode)
 void widget_list::toggle_move_mode()
 {
 	move_mode = !move_mode;
+	dirty = true;
 
 	for (auto widget : widgets)
 		widget->active = !move_mode;
@@ -205,8 +816,15 @@ bool widget_list::get_move_mode()
 
 std::string widget_list::to_string()
 {
-	std::string widgets_str{};
+	// widget and style code starts with the type name on its own line, it is what create_widget/create_style get instantiated with
+	auto get_type_name = [](const std::string& code)
+	{
+		auto start = code.find_first_not_of('\t');
+		return code.substr(start, code.find('\n') - start);
+	};
+
 	std::string styles_str{};
+	std::string widgets_str{};
 	std::vector<style*> styles_to_save{};
 
 	for (auto& w : widgets)
@@ -218,22 +836,20 @@ std::string widget_list::to_string()
 		{
 			styles_to_save.push_back(w->p_style);
 			style_idx = static_cast<uint32_t>(styles_to_save.size() - 1); // index is last added
-			styles_str += (styles_str.empty() ? "\n" : ",\n") + w->p_style->to_string(3);
+
+			auto style_str = w->p_style->to_string(2);
+			styles_str += "\tauto p_style_" + std::to_string(style_idx) + " = list.create_style<" + get_type_name(style_str) + ">(\n" + style_str + ");\n";
 		}
 		else
 			style_idx = static_cast<uint32_t>(std::distance(styles_to_save.begin(), iterator));
 	
-		widgets_str += "\t\towned_widget\n\t\t{\nstd::make_unique<widget>(\n" + w->to_string(4) + ", " + std::to_string(style_idx) + "/*owned_widget style*/ index\n\t\t}" +
-			(w == widgets.back() ? "" : ",") + "\n";
+		auto widget_str = w->to_string(2);
+		widgets_str += "\tlist.create_widget<" + get_type_name(widget_str) + ">(\n" + widget_str + ")->set_style(p_style_" + std::to_string(style_idx) + ");\n";
 	}
 	
-	return "widget_list\n{\n\t" +
+	return "widget_list list\n{\n\t" +
 		top_left.to_string() + ',' + size.to_string() + ",\n" +
-		background.to_string(2) + ",\n\t" +
-		"std::vector<owned_widget>\n\t{\n" +
-		widgets_str +
-		"\t},\n\t" +
-		"std::vector<style>\n\t{\n" +
-		styles_str +
-		"\n\t}\n};";
-}
\ No newline at end of file
+		background.to_string(2) + "\n};\n\n" +
+		styles_str + "\n" +
+		widgets_str;
+}
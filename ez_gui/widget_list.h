@@ -1,9 +1,12 @@
 #pragma once
 
 #include <vector>
-#include <queue>
-#include <mutex>
 #include <memory>
+#include <optional>
+#include <unordered_map>
+#include <typeinfo>
+#include <thread>
+#include <atomic>
 
 #include "widgets.h"
 
@@ -24,6 +27,81 @@ struct owned_widget
     owned_widget(std::unique_ptr<widget> p_wdgt, uint32_t owned_styles_idx);
 };
 
+// uniform grid over widget bounds so hit testing only has to look at the widgets around a point
+class widget_grid
+{
+public:
+	widget_grid();
+
+	// add bounds under a widget index
+	void insert(uint32_t idx, const region& bounds);
+
+	// remove bounds that were inserted under a widget index
+	void erase(uint32_t idx, const region& bounds);
+
+	// remove every widget from the grid
+	void clear();
+
+	// get the indices of widgets whose bounds overlap the cell pos is in, nullptr if there are none
+	const std::vector<uint32_t>* query(const vec2& pos) const;
+
+	// add the indices of widgets whose bounds overlap any cell bounds covers to indices, an index can be added more than once
+	void query(const region& bounds, std::vector<uint32_t>& indices) const;
+
+	// width and height of a grid cell in pixels
+	static constexpr float cell_size = 64.f;
+
+private:
+	std::unordered_map<uint64_t, std::vector<uint32_t>> cells; // widget indices by packed cell coordinates
+
+	// pack cell coordinates into a single key
+	static uint64_t cell_key(int32_t x, int32_t y);
+
+	// get the cell range bounds cover
+	static void get_cell_range(const region& bounds, int32_t& min_x, int32_t& min_y, int32_t& max_x, int32_t& max_y);
+};
+
+// kind of draw pass a widget pool gets drawn with
+enum class pool_kind : uint8_t
+{
+	float_slider, // slider<float>, drawn in one loop
+	checkbox,	  // checkbox, drawn in one loop
+	generic		  // any other widget, drawn through its own draw()
+};
+
+// the widgets of one kind in one draw layer, so a draw pass can walk every instance in a single loop
+// widgets in the same layer do not overlap, labels included, so drawing pools in sort key order instead of list order keeps the same widgets on top
+// sliders and checkboxes keep what their draw pass reads in arrays, an instance is gathered again from its widget only when the widget changed
+struct widget_pool
+{
+	uint32_t sort_key;					 // draw layer << 8 | pool kind
+	pool_kind kind;
+	std::vector<uint32_t> indices;		 // index of every instance in the widget list
+	std::vector<vec2> positions;		 // top left of every instance
+	std::vector<vec2> sizes;			 // size of every instance
+	std::vector<vec2> label_positions;	 // label position of every instance, relative to its top left
+	std::vector<std::wstring> labels;	 // label of every instance
+	std::vector<uint32_t> style_indices; // index of every instance's style in styles
+	std::vector<style*> styles;			 // every distinct style the instances use
+	std::vector<const float*> floats;	 // value of every float slider
+	std::vector<float> min_values;		 // minimum of every float slider
+	std::vector<float> ranges;			 // range of every float slider
+	std::vector<const bool*> bools;		 // value of every checkbox
+	geometry_cache geometry;			 // geometry of the last draw pass, added again while no instance changed
+
+	widget_pool(uint32_t sort_key, pool_kind kind);
+
+	// add a widget to the pool by its index in the widget list
+	void add_instance(uint32_t idx, widget* p_widget);
+
+	// copy what the draw pass reads from a widget into the arrays of instance i
+	// returns true if the label, label position or style changed, those move the widget's draw extent
+	bool gather_instance(size_t i, widget* p_widget);
+
+	// get the pool kind a widget is drawn with
+	static pool_kind get_kind(widget* p_widget);
+};
+
 class widget_list
 {
 public:
@@ -32,6 +110,8 @@ public:
     widget_list(widget_list&&) = default;
 	widget_list(const vec2& top_left, const vec2& size);
 	widget_list(const vec2& top_left, const vec2& size, const mc_rect& background);
+	// every owned widget and style is a separate heap allocation, build lists with create_widget/create_style instead, like to_string() prints them
+	[[deprecated("construct the list and add its widgets and styles with create_widget/create_style")]]
 	widget_list(const vec2& top_left, const vec2& size, const mc_rect& background, std::vector<owned_widget> owned_widgets, std::vector<std::unique_ptr<style>> owned_styles);
 
 	// add a single widget to the widget list
@@ -40,6 +120,23 @@ public:
 	// add multiple widgets
 	void add_widgets(widget* p_widgets, size_t count);
 
+	// construct a widget in the list's arena and add it, the list owns it and frees it together with every other arena object
+	template <typename Ty, typename... Args>
+	Ty* create_widget(Args&&... args)
+	{
+		auto p_widget = get_arena().create<Ty>(std::forward<Args>(args)...);
+		add_widget(p_widget);
+
+		return p_widget;
+	}
+
+	// construct a style in the list's arena, it lives as long as the list
+	template <typename Ty, typename... Args>
+	Ty* create_style(Args&&... args)
+	{
+		return get_arena().create<Ty>(std::forward<Args>(args)...);
+	}
+
 	// remove a widget by its address
 	bool remove_widget(widget* p_widget);
 
@@ -49,25 +146,65 @@ public:
 	// check if a location is inside of a widget list
 	bool contains(const vec2& pos);
 
-	// insert an input message to the message queue
+	// get the topmost widget in draw order that contains pos, nullptr if no widget does
+	widget* hit_test(const vec2& pos);
+
+	// re-index every widget's bounds and re-record their geometry, update() picks up widgets that were moved or resized on its own
+	void refresh_widget_bounds();
+
+	// mark every widget whose style p_field points into dirty, nullptr marks nothing
+	void mark_style_users_dirty(const void* p_field);
+
+	// give the keyboard focus to a widget, nullptr or a widget that is not focusable clears the focus
+	void set_focus(widget* p_widget);
+
+	// get the widget that owns the keyboard focus, nullptr if none does
+	widget* get_focus();
+
+	// insert an input message to the message queue, this can be called from a different thread than draw_widgets
+	// only one thread may add input messages to a list
 	void add_input_msg(const widget_input& msg);
 
+	// move input messages that are waiting because the queue was full into the queue, call it from the thread that adds input messages
+	void flush_input_msgs();
+
+	// get the input queue counters from the last time the queue was drained
+	input_stats get_input_stats() const;
+
 	// activate/deactivate the widget list, deactivated lists will ignore added input messages and will not draw any widgets
 	void set_active(bool active);
 
+	// get if the widget list is active
+	bool is_active() const;
+
+	// get the amount of widgets in the list
+	size_t get_widget_count() const;
+
 	// activate/deactive the move mode of the list, lists in move mode will allow widgets to be moved by dragging, and widgets will not respond to input how they normally would
 	void set_move_mode(bool mode);
 
 	// toggle move mode based on its currents state
 	void toggle_move_mode();
 
+	// draw from widget pools instead of one widget at a time, sliders and checkboxes then get drawn in one loop per pool
+	// pools are rebuilt when widgets are added, removed, moved or resized, or when a label or style changes
+	void set_pooled_draw(bool pooled);
+
+	// get if the list draws from widget pools
+	bool get_pooled_draw() const;
+
 	// get the current movement mode
 	bool get_move_mode();
 
-	// handles input messages from the queue and submits widget geometry to the gpu
+	// handle input messages from the queue and check the widgets for changes, returns true if the list has to be drawn again
+	// a changed list marks the renderer dirty, so every list gets drawn in a frame where any list changed
+	bool update();
+
+	// submits widget geometry to the gpu, update() should be called first in the same frame
+	// widgets that did not change add the geometry they recorded last time instead of drawing again
 	void draw_widgets();
 
-	// print out needed code for the widget_list
+	// print out needed code for the widget_list, widgets and styles are made in the list's arena with create_widget/create_style
 	std::string to_string();
 
 private:
@@ -76,21 +213,138 @@ private:
 	mc_rect background;					  // can contain a multicolored background that gets drawn under all widgets
 	bool active;						  // if a widget list is active, the widgets will be drawn and inputs will be pushed into the queue, if not, it is "invisible"
 	bool move_mode;						  // if move mode is true, widgets in the list can be dragged around for repositioning
+	bool dirty;							  // the list or its widgets changed since the list was last drawn
 
 	std::vector<widget*> widgets;				       // vector of widget ptrs the list contains
+	std::vector<region> widget_bounds;				   // bounds each widget had when it was put in the hit grid
+	widget_grid hit_grid;							   // spatial index of widget bounds for hit testing
+	int32_t captured_idx;							   // index of the widget that got the last lbutton_down, -1 if none
+	int32_t focused_idx;							   // index of the widget key presses go to, -1 if none
 	std::vector<owned_widget> owned_widgets;           // vector of widgets this instance owns
 	std::vector<std::unique_ptr<style>> owned_styles;  // vector of styles this instance owns, must be heap allocated to avoid object slicing
-	std::queue<widget_input> input_msgs;		       // input message queue
+	std::unique_ptr<widget_arena> p_arena;			   // widgets and styles made with create_widget/create_style, heap allocated so they do not move with the list
+	std::unique_ptr<input_channel> p_input_msgs;	   // input message queue, heap allocated so the list stays movable
+	input_stats last_input_stats;					   // input queue counters from the last drain
+	bool pooled_draw;								   // draw from pools instead of one widget at a time
+	bool pools_dirty;								   // widgets were added, removed or moved since the pools were built
+	std::vector<widget_pool> pools;					   // widget pools in draw order
+
+	// widgets whose draw extents are closer than this are put in different draw layers, borders reach outside of the extents
+	static constexpr float layer_margin = 4.f;
+
+	// handle every input message in the queue in order, called in update()
+	// consecutive mouse moves are merged into the latest one, inactive lists drop their messages
+	void handle_input_msgs();
+
+	// pass a single input message on to the widgets
+	void handle_input(const widget_input& msg);
+
+	// get the index of the topmost widget in draw order that contains pos, -1 if no widget does
+	int32_t hit_test_index(const vec2& pos);
 
-	// handle next input message in the queue, if no messages are present, the function just returns, called in draw_widgets() before drawing
-	void handle_next_input();
+	// move a widget's bounds in the hit grid to where the widget is now, a widget that moved gets marked dirty and the pools rebuilt
+	void update_widget_bounds(uint32_t idx);
+
+	// move the keyboard focus to a widget index, -1 or an index of a widget that is not focusable clears the focus
+	void set_focus_index(int32_t idx);
+
+	// move the keyboard focus to the next focusable widget in draw order, wrapping around
+	void focus_next();
+
+	// get the list's arena, it is created on first use
+	widget_arena& get_arena();
+
+	// draw a single widget, or add its cached geometry if it did not change
+	void draw_widget(uint32_t idx);
+
+	// sort the widgets into pools by draw layer and kind, a widget goes one layer above every earlier widget its draw extent overlaps
+	void rebuild_pools();
+
+	// draw a slider or checkbox pool, or add its cached geometry if none of its widgets changed
+	// a changed widget gets the whole pool recorded again, in one loop over the pool's arrays
+	void draw_pool(widget_pool& pool);
 };
 
 namespace globals
 {
-	// globally accessed list of all widget lists
+	// globally accessed list of all widget lists, lists are drawn in order so the last list is the topmost
 	inline std::vector<widget_list> widget_lists;
 
+	// index of the widget list that got the last lbutton_down, it gets every mouse message until the button is released, -1 if none
+	inline int32_t captured_list_idx = -1;
+
+	// index of the widget list that was clicked last, it gets the keyboard input, -1 if none
+	inline int32_t focused_list_idx = -1;
+
+	// get the index of the topmost active widget list that contains pos, -1 if no list does
+	inline int32_t find_topmost_widget_list(const vec2& pos)
+	{
+		for (auto i = static_cast<int32_t>(widget_lists.size()) - 1; i >= 0; --i)
+		{
+			if (widget_lists[i].is_active() && widget_lists[i].contains(pos))
+				return i;
+		}
+
+		return -1;
+	}
+
+	// draw lists the widget lists get recorded into when they are drawn on worker threads, one per widget list
+	inline std::vector<std::unique_ptr<draw_list>> list_draw_lists;
+
+	// draw every widget list, with more than 1 thread in workers the lists are recorded in parallel into their own draw lists and then spliced in list order
+	// workers should be created once and kept, starting threads every frame costs more than recording a small list
+	// lists with fewer than PARALLEL_DRAW_MIN_WIDGETS widgets in total are drawn serially, waking the workers and splicing costs more than it saves
+	// text that is not in the text cache gets laid out under the renderer's text lock, so lists with a lot of changing text record mostly one at a time
+	inline void draw_widget_lists(worker_pool& workers)
+	{
+		auto p_renderer = widget::p_renderer;
+
+		size_t widget_count = 0;
+		for (auto& widget_list : widget_lists)
+			widget_count += widget_list.get_widget_count();
+
+		if (workers.get_thread_count() <= 1 || widget_lists.size() <= 1 || widget_count < PARALLEL_DRAW_MIN_WIDGETS)
+		{
+			for (auto& widget_list : widget_lists)
+				widget_list.draw_widgets();
+
+			return;
+		}
+
+		while (list_draw_lists.size() < widget_lists.size())
+			list_draw_lists.push_back(std::make_unique<draw_list>());
+
+		workers.run(widget_lists.size(), [p_renderer](size_t idx)
+		{
+			p_renderer->set_thread_draw_list(list_draw_lists[idx].get());
+			widget_lists[idx].draw_widgets();
+			p_renderer->set_thread_draw_list(nullptr);
+		});
+
+		for (auto i = 0u; i < widget_lists.size(); ++i)
+			p_renderer->splice_draw_list(*list_draw_lists[i]);
+	}
+
+	// mark every widget in every list whose style p_field points into dirty, used when a widget is bound to a style field
+	inline void mark_style_users_dirty(const void* p_field)
+	{
+		for (auto& widget_list : widget_lists)
+			widget_list.mark_style_users_dirty(p_field);
+	}
+
+	// move waiting input messages of every widget list into their queues, call it once per message loop from the thread that pumps window messages
+	inline void flush_widget_list_input()
+	{
+		for (auto& widget_list : widget_lists)
+			widget_list.flush_input_msgs();
+	}
+
+	// get a widget list by an index that may be stale, nullptr if it is -1 or out of range
+	inline widget_list* get_widget_list(int32_t idx)
+	{
+		return idx >= 0 && idx < static_cast<int32_t>(widget_lists.size()) ? &widget_lists[idx] : nullptr;
+	}
+
 	// wndproc handler function that passes messages onto widget lists
 	inline bool widget_list_wndproc_handler(HWND hwnd, UINT message, WPARAM w_param, LPARAM l_param)
 	{
@@ -101,33 +355,59 @@ namespace globals
 			return vec2{ static_cast<float>(wnd_pos.left), static_cast<float>(wnd_pos.top) };
 		};
 
+		// the window shows whatever was presented last until the next present, so anything that exposes or resizes it needs a new frame
+		auto mark_frame_dirty = []()
+		{
+			if (widget::p_renderer)
+				widget::p_renderer->mark_dirty();
+		};
+
 		static vec2 wnd_pos;
 
 		switch (message)
 		{
 		case WM_CREATE:
 		case WM_MOVE:
+			wnd_pos = get_window_pos();
+			break;
 		case WM_SIZE:
 			wnd_pos = get_window_pos();
+			mark_frame_dirty();
 			break;
+		case WM_PAINT:
+		case WM_SHOWWINDOW:
+		case WM_DISPLAYCHANGE:
+			// not handled, DefWindowProc still has to validate the window or WM_PAINT keeps coming
+			mark_frame_dirty();
+			return false;
 		case WM_MOUSEMOVE:
-			for (auto& widgets : widget_lists)
-				widgets.add_input_msg(widget_input{ vec2{GET_X_LPARAM(l_param), GET_Y_LPARAM(l_param)} });
+			// widgets only react to mouse moves while they are being clicked, so only the captured list needs them
+			if (auto p_list = get_widget_list(captured_list_idx))
+				p_list->add_input_msg(widget_input{ vec2{GET_X_LPARAM(l_param), GET_Y_LPARAM(l_param)} });
 			break;
 		case WM_LBUTTONDOWN:
+		{
 			SetCapture(hwnd);
-			for (auto& widgets : widget_lists)
-				widgets.add_input_msg(widget_input{ input_type::lbutton_down, vec2{GET_X_LPARAM(l_param), GET_Y_LPARAM(l_param)} });
+			vec2 m_pos{ GET_X_LPARAM(l_param), GET_Y_LPARAM(l_param) };
+
+			captured_list_idx = find_topmost_widget_list(m_pos);
+			focused_list_idx = captured_list_idx;
+
+			if (auto p_list = get_widget_list(captured_list_idx))
+				p_list->add_input_msg(widget_input{ input_type::lbutton_down, m_pos });
 			break;
+		}
 		case WM_LBUTTONUP:
 			//std::cout << "WM_LBUTTONUP" << std::endl;
 			ReleaseCapture();
-			for (auto& widgets : widget_lists)
-				widgets.add_input_msg(widget_input{ input_type::lbutton_up, vec2{GET_X_LPARAM(l_param), GET_Y_LPARAM(l_param)} });
+			if (auto p_list = get_widget_list(captured_list_idx))
+				p_list->add_input_msg(widget_input{ input_type::lbutton_up, vec2{GET_X_LPARAM(l_param), GET_Y_LPARAM(l_param)} });
+
+			captured_list_idx = -1;
 			break;
 		case WM_CHAR:
-			for (auto& widgets : widget_lists)
-				widgets.add_input_msg(static_cast<char>(w_param));
+			if (auto p_list = get_widget_list(focused_list_idx))
+				p_list->add_input_msg(static_cast<char>(w_param));
 			break;
 		default:
 			return false;
@@ -211,228 +491,189 @@ inline static widget_list get_slider_style_edit_list(slider_style* p_slider_styl
 
 	return list;*/
 
-    std::vector<owned_widget> owned_widgets{};
-
-    owned_widgets.emplace_back(
-        std::make_unique<slider<float>>(
-            vec2{ 156.000000f, 102.000000f }, 
-            vec2{ 150.000000f, 20.000000f },
-            L"text_size", 
-            vec2{ 150.000000f, 0.000000f },
-            &p_slider_style->text.size, 
-            6.000000, 
-            50.000000, 
-            nullptr
-        ), 
-        0/*owned_widget style index*/
-    );
-    owned_widgets.emplace_back(
-        std::make_unique<slider<float>>(
-            vec2{ 155.000000f, 143.000000f }, 
-            vec2{ 150.000000f, 20.000000f },
-            L"text ol thckns",
-            vec2{ 150.000000f, 0.000000f },
-            &p_slider_style->text.ol_thckns,
-            0.000000,
-            5.000000,
-            nullptr
-        ),
-        0/*owned_widget style index*/  
+    widget_list list
+    {
+        vec2{ 0.000000f, 0.000000f },
+        vec2{ 1000.000000f, 1000.000000f },
+        mc_rect
+        {
+        {0.25f}
+        }
+    };
+
+    auto p_slider_edit_style = list.create_style<slider_style>(
+        text_style
+        {
+            14.000000, 1.000000,
+            { 1.000000, 1.000000, 1.000000, 1.000000 },
+            { 0.000000, 0.000000, 0.000000, 1.000000 },
+            { 0.000000, 0.000000, 0.000000, 0.000000 }
+        },
+        border_style
+        {
+            2.000000, 0.000000,
+            { 0.000000, 0.000000, 0.000000, 1.000000 },
+            { 0.000000, 0.000000, 0.000000, 0.000000 }
+        },
+        mc_rect
+        {
+            { 0.000000, 0.000000, 0.000000, 0.000000 },
+            { 0.000000, 0.000000, 0.000000, 0.000000 },
+            { 0.000000, 0.000000, 0.000000, 0.000000 },
+            { 0.000000, 0.000000, 0.000000, 0.000000 }
+        },
+        mc_rect
+        {
+            { 1.000000, 1.000000, 1.000000, 1.000000 },
+            { 1.000000, 1.000000, 1.000000, 1.000000 },
+            { 1.000000, 1.000000, 1.000000, 1.000000 },
+            { 1.000000, 1.000000, 1.000000, 1.000000 }
+        }
     );
-    owned_widgets.emplace_back(
-        std::make_unique<color_picker>(
-            vec2{ 3.000000f, 3.000000f }, vec2{ 150.000000f, 80.000000f },
-            L"text color", vec2{ 150.000000f, 0.000000f }, &p_slider_style->text.clr, nullptr
-        ), 
-        1/*owned_widget style index*/ 
+
+    auto p_picker_edit_style = list.create_style<color_picker_style>(
+        text_style
+        {
+                14.000000, 1.000000,
+                { 1.000000, 1.000000, 1.000000, 1.000000 },
+                { 0.000000, 0.000000, 0.000000, 1.000000 },
+                { 0.000000, 0.000000, 0.000000, 0.000000 }
+        },
+        border_style
+        {
+                2.000000, 0.000000,
+                { 0.000000, 0.000000, 0.000000, 1.000000 },
+                { 0.000000, 0.000000, 0.000000, 0.000000 }
+        },
+        mc_rect
+        {
+                { 0.000000, 0.000000, 0.000000, 0.000000 },
+                { 0.000000, 0.000000, 0.000000, 0.000000 },
+                { 0.000000, 0.000000, 0.000000, 0.000000 },
+                { 0.000000, 0.000000, 0.000000, 0.000000 }
+        },
+        border_style
+        {
+                2.000000, 0.000000,
+                { 0.000000, 0.000000, 0.000000, 1.000000 },
+                { 0.000000, 0.000000, 0.000000, 0.000000 }
+        },
+        3.000000
     );
-    owned_widgets.emplace_back(
-        std::make_unique<color_picker>(
-            vec2{ 156.000000f, 3.000000f }, vec2{ 150.000000f, 80.000000f },
-            L"text ol color", vec2{ 150.000000f, 0.000000f }, &p_slider_style->text.ol_clr, nullptr
-        ), 
-        1/*owned_widget style index*/
+
+    list.create_widget<slider<float>>(
+        vec2{ 156.000000f, 102.000000f },
+        vec2{ 150.000000f, 20.000000f },
+        L"text_size",
+        vec2{ 150.000000f, 0.000000f },
+        &p_slider_style->text.size,
+        6.000000,
+        50.000000,
+        p_slider_edit_style
     );
-    owned_widgets.emplace_back(
-        
-        std::make_unique<color_picker>(
-            vec2{ 3.000000f, 85.000000f }, vec2{ 150.000000f, 80.000000f },
-            L"text bg color", vec2{ 150.000000f, 0.000000f },&p_slider_style->text.bg_clr, nullptr
-        ), 
-        1/*owned_widget style index*/
-        
+
+    list.create_widget<slider<float>>(
+        vec2{ 155.000000f, 143.000000f },
+        vec2{ 150.000000f, 20.000000f },
+        L"text ol thckns",
+        vec2{ 150.000000f, 0.000000f },
+        &p_slider_style->text.ol_thckns,
+        0.000000,
+        5.000000,
+        p_slider_edit_style
     );
-    owned_widgets.emplace_back(
-        std::make_unique<slider<float>>(
-                vec2{ 3.000000f, 189.000000f }, vec2{ 150.000000f, 20.000000f },
-                L"border thckns",vec2{ 150.000000f, 0.000000f },
-                & p_slider_style->border.thckns,0.000000,5.000000, nullptr
-        ), 0/*owned_widget style index*/
-        
+
+    list.create_widget<color_picker>(
+        vec2{ 3.000000f, 3.000000f }, vec2{ 150.000000f, 80.000000f },
+        L"text color", vec2{ 150.000000f, 0.000000f }, &p_slider_style->text.clr, p_picker_edit_style
     );
-    owned_widgets.emplace_back(
-        std::make_unique<slider<float>>(
-            vec2{ 3.000000f, 167.000000f }, 
-            vec2{ 150.000000f, 20.000000f },
-            L"border ol thickness",
-            vec2{ 150.000000f, 0.000000f },
-            &p_slider_style->border.ol_thckns,
-            0.000000,
-            5.000000, 
-            nullptr
-        ), 0/*owned_widget style index*/
-        
+
+    list.create_widget<color_picker>(
+        vec2{ 156.000000f, 3.000000f }, vec2{ 150.000000f, 80.000000f },
+        L"text ol color", vec2{ 150.000000f, 0.000000f }, &p_slider_style->text.ol_clr, p_picker_edit_style
     );
-    owned_widgets.emplace_back(  
-        std::make_unique<color_picker>(
-            vec2{ 3.000000f, 211.000000f }, vec2{ 150.000000f, 80.000000f },
-            L"border color", vec2{ 150.000000f, 0.000000f }, &p_slider_style->border.clr, nullptr
-        ), 1/*owned_widget style index*/
+
+    list.create_widget<color_picker>(
+        vec2{ 3.000000f, 85.000000f }, vec2{ 150.000000f, 80.000000f },
+        L"text bg color", vec2{ 150.000000f, 0.000000f },&p_slider_style->text.bg_clr, p_picker_edit_style
     );
-    owned_widgets.emplace_back(
-        std::make_unique<color_picker>(
-                vec2{ 156.000000f, 211.000000f }, vec2{ 150.000000f, 80.000000f },
-                L"border ol color", vec2{ 150.000000f, 0.000000f }, &p_slider_style->border.ol_clr, nullptr
-        ), 1/*owned_widget style index*/   
+
+    list.create_widget<slider<float>>(
+            vec2{ 3.000000f, 189.000000f }, vec2{ 150.000000f, 20.000000f },
+            L"border thckns",vec2{ 150.000000f, 0.000000f },
+            & p_slider_style->border.thckns,0.000000,5.000000, p_slider_edit_style
     );
-    owned_widgets.emplace_back(
-        std::make_unique<color_picker>(
-            vec2{ 3.000000f, 295.000000f },  vec2{ 150.000000f, 80.000000f },
-            L"bg top left",  vec2{ 150.000000f, 0.000000f }, &p_slider_style->bg.tl_clr, nullptr
-        ), 
-        1/*owned_widget style index*/
+
+    list.create_widget<slider<float>>(
+        vec2{ 3.000000f, 167.000000f },
+        vec2{ 150.000000f, 20.000000f },
+        L"border ol thickness",
+        vec2{ 150.000000f, 0.000000f },
+        &p_slider_style->border.ol_thckns,
+        0.000000,
+        5.000000,
+        p_slider_edit_style
     );
-    owned_widgets.emplace_back(
-        std::make_unique<color_picker>(
-            vec2{ 157.000000f, 295.000000f }, vec2{ 150.000000f, 80.000000f },
-            L"bg top right",  vec2{ 150.000000f, 0.000000f }, &p_slider_style->bg.tr_clr, nullptr
-        ), 
-        1/*owned_widget style index*/
+
+    list.create_widget<color_picker>(
+        vec2{ 3.000000f, 211.000000f }, vec2{ 150.000000f, 80.000000f },
+        L"border color", vec2{ 150.000000f, 0.000000f }, &p_slider_style->border.clr, p_picker_edit_style
     );
-    owned_widgets.emplace_back(
-        std::make_unique<color_picker>(
-                
-            vec2{ 4.000000f, 379.000000f }, vec2{ 150.000000f, 80.000000f },
-                L"bg btm left", vec2{ 150.000000f, 0.000000f }, &p_slider_style->bg.bl_clr, nullptr
-        ), 1/*owned_widget style index*/
+
+    list.create_widget<color_picker>(
+            vec2{ 156.000000f, 211.000000f }, vec2{ 150.000000f, 80.000000f },
+            L"border ol color", vec2{ 150.000000f, 0.000000f }, &p_slider_style->border.ol_clr, p_picker_edit_style
     );
-    owned_widgets.emplace_back(
-        std::make_unique<color_picker>(
-                
-            vec2{ 158.000000f, 380.000000f }, vec2{ 150.000000f, 80.000000f },
-                L"bg btm right", vec2{ 150.000000f, 0.000000f }, &p_slider_style->bg.br_clr, nullptr
-        ), 
-        1/*owned_widget style index*/
+
+    list.create_widget<color_picker>(
+        vec2{ 3.000000f, 295.000000f },  vec2{ 150.000000f, 80.000000f },
+        L"bg top left",  vec2{ 150.000000f, 0.000000f }, &p_slider_style->bg.tl_clr, p_picker_edit_style
     );
-    owned_widgets.emplace_back(
-        std::make_unique<color_picker>(
-                
-            vec2{ 2.000000f, 465.000000f }, vec2{ 150.000000f, 80.000000f },
-                L"slide top left", vec2{ 150.000000f, 0.000000f }, &p_slider_style->clr.tl_clr, nullptr
-        ), 
-        1/*owned_widget style index*/
+
+    list.create_widget<color_picker>(
+        vec2{ 157.000000f, 295.000000f }, vec2{ 150.000000f, 80.000000f },
+        L"bg top right",  vec2{ 150.000000f, 0.000000f }, &p_slider_style->bg.tr_clr, p_picker_edit_style
     );
-    owned_widgets.emplace_back(
-        std::make_unique<color_picker>(
-                
-                vec2{ 157.000000f, 465.000000f }, vec2{ 150.000000f, 80.000000f },
-                L"slide top right", vec2{ 150.000000f, 0.000000f }, &p_slider_style->clr.tr_clr, nullptr
-        ), 
-        1/*owned_widget style index*/
+
+    list.create_widget<color_picker>(
+
+        vec2{ 4.000000f, 379.000000f }, vec2{ 150.000000f, 80.000000f },
+            L"bg btm left", vec2{ 150.000000f, 0.000000f }, &p_slider_style->bg.bl_clr, p_picker_edit_style
     );
-    owned_widgets.emplace_back(
-        std::make_unique<color_picker>(
-                
-                vec2{ 2.000000f, 550.000000f }, vec2{ 150.000000f, 80.000000f },
-                L"slide btm left", vec2{ 150.000000f, 0.000000f }, &p_slider_style->clr.bl_clr, nullptr
-        ), 
-        1/*owned_widget style index*/
+
+    list.create_widget<color_picker>(
+
+        vec2{ 158.000000f, 380.000000f }, vec2{ 150.000000f, 80.000000f },
+            L"bg btm right", vec2{ 150.000000f, 0.000000f }, &p_slider_style->bg.br_clr, p_picker_edit_style
     );
-    owned_widgets.emplace_back(
-        std::make_unique<color_picker>(
-            vec2{ 157.000000f, 550.000000f },
-            vec2{ 150.000000f, 80.000000f },
-            L"slide btm right",
-            vec2{ 150.000000f, 0.000000f },
-            &p_slider_style->clr.br_clr,
-            nullptr
-        ), 1/*owned_widget style index*/
-        
+
+    list.create_widget<color_picker>(
+
+        vec2{ 2.000000f, 465.000000f }, vec2{ 150.000000f, 80.000000f },
+            L"slide top left", vec2{ 150.000000f, 0.000000f }, &p_slider_style->clr.tl_clr, p_picker_edit_style
     );
-    
-    std::vector<std::unique_ptr<style>> owned_styles{};
-    
-    owned_styles.emplace_back(
-        std::make_unique<slider_style>(
-            text_style
-            {
-                14.000000, 1.000000,
-                { 1.000000, 1.000000, 1.000000, 1.000000 },
-                { 0.000000, 0.000000, 0.000000, 1.000000 },
-                { 0.000000, 0.000000, 0.000000, 0.000000 }
-            },
-            border_style
-            {
-                2.000000, 0.000000,
-                { 0.000000, 0.000000, 0.000000, 1.000000 },
-                { 0.000000, 0.000000, 0.000000, 0.000000 }
-            },
-            mc_rect
-            {
-                { 0.000000, 0.000000, 0.000000, 0.000000 },
-                { 0.000000, 0.000000, 0.000000, 0.000000 },
-                { 0.000000, 0.000000, 0.000000, 0.000000 },
-                { 0.000000, 0.000000, 0.000000, 0.000000 }
-            },
-            mc_rect
-            {
-                { 1.000000, 1.000000, 1.000000, 1.000000 },
-                { 1.000000, 1.000000, 1.000000, 1.000000 },
-                { 1.000000, 1.000000, 1.000000, 1.000000 },
-                { 1.000000, 1.000000, 1.000000, 1.000000 }
-            }
-        )
+
+    list.create_widget<color_picker>(
+
+            vec2{ 157.000000f, 465.000000f }, vec2{ 150.000000f, 80.000000f },
+            L"slide top right", vec2{ 150.000000f, 0.000000f }, &p_slider_style->clr.tr_clr, p_picker_edit_style
     );
-    owned_styles.emplace_back(
-        std::make_unique<color_picker_style>(
-            text_style
-            {
-                    14.000000, 1.000000,
-                    { 1.000000, 1.000000, 1.000000, 1.000000 },
-                    { 0.000000, 0.000000, 0.000000, 1.000000 },
-                    { 0.000000, 0.000000, 0.000000, 0.000000 }
-            },
-            border_style
-            {
-                    2.000000, 0.000000,
-                    { 0.000000, 0.000000, 0.000000, 1.000000 },
-                    { 0.000000, 0.000000, 0.000000, 0.000000 }
-            },
-            mc_rect
-            {
-                    { 0.000000, 0.000000, 0.000000, 0.000000 },
-                    { 0.000000, 0.000000, 0.000000, 0.000000 },
-                    { 0.000000, 0.000000, 0.000000, 0.000000 },
-                    { 0.000000, 0.000000, 0.000000, 0.000000 }
-            },
-            border_style
-            {
-                    2.000000, 0.000000,
-                    { 0.000000, 0.000000, 0.000000, 1.000000 },
-                    { 0.000000, 0.000000, 0.000000, 0.000000 }
-            },
-            3.000000
-        )
+
+    list.create_widget<color_picker>(
+
+            vec2{ 2.000000f, 550.000000f }, vec2{ 150.000000f, 80.000000f },
+            L"slide btm left", vec2{ 150.000000f, 0.000000f }, &p_slider_style->clr.bl_clr, p_picker_edit_style
     );
-    
-    return widget_list(
-        vec2{ 0.000000f, 0.000000f },
-        vec2{ 1000.000000f, 1000.000000f },
-        mc_rect
-        {
-            {0.25f}
-        },
-        std::move(owned_widgets),
-        std::move(owned_styles)
+
+    list.create_widget<color_picker>(
+        vec2{ 157.000000f, 550.000000f },
+        vec2{ 150.000000f, 80.000000f },
+        L"slide btm right",
+        vec2{ 150.000000f, 0.000000f },
+        &p_slider_style->clr.br_clr,
+        p_picker_edit_style
     );
+
+
+    return list;
 }
\ No newline at end of file
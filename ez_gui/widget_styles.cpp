@@ -19,6 +19,18 @@ std::string style::to_string(uint16_t indent_amt) const
 	return "base style called";
 }
 
+size_t style::get_size() const
+{
+	return sizeof(style);
+}
+
+bool style::contains(const void* p_field) const
+{
+	auto p_begin = reinterpret_cast<const uint8_t*>(this);
+	auto p = static_cast<const uint8_t*>(p_field);
+	return p >= p_begin && p < p_begin + get_size();
+}
+
 //
 // text_style definitions
 //
@@ -61,6 +73,11 @@ std::string text_style::to_string(uint16_t indent_amt) const
 		brace_str + "}";															//},
 }
 
+size_t text_style::get_size() const
+{
+	return sizeof(text_style);
+}
+
 //
 // border style definitions
 //
@@ -100,6 +117,11 @@ std::string border_style::to_string(uint16_t indent_amt) const
 
 }
 
+size_t border_style::get_size() const
+{
+	return sizeof(border_style);
+}
+
 //
 // multicolored rectangle definitions
 //
@@ -139,6 +161,11 @@ std::string mc_rect::to_string(uint16_t indent_amt) const
 		brace_str + "}";						//}
 }
 
+size_t mc_rect::get_size() const
+{
+	return sizeof(mc_rect);
+}
+
 //
 // checkbox style definitions
 //
@@ -174,6 +201,11 @@ std::string checkbox_style::to_string(uint16_t indent_amt) const
 		brace_str + '}';
 }
 
+size_t checkbox_style::get_size() const
+{
+	return sizeof(checkbox_style);
+}
+
 //
 // button style definitions
 //
@@ -203,6 +235,11 @@ std::string button_style::to_string(uint16_t indent_amt) const
 		'\n' + brace_str + '}';
 }
 
+size_t button_style::get_size() const
+{
+	return sizeof(button_style);
+}
+
 //
 // slider style definitions
 //
@@ -234,6 +271,11 @@ std::string slider_style::to_string(uint16_t indent_amt) const
 		brace_str + '}';
 }
 
+size_t slider_style::get_size() const
+{
+	return sizeof(slider_style);
+}
+
 //
 // text entry style definitions
 //
@@ -273,6 +315,11 @@ std::string text_entry_style::to_string(uint16_t indent_amt) const
 		brace_str + '}';
 }
 
+size_t text_entry_style::get_size() const
+{
+	return sizeof(text_entry_style);
+}
+
 //
 // combo box style definitions
 //
@@ -308,6 +355,11 @@ std::string combo_box_style::to_string(uint16_t indent_amt) const
 		brace_str + '}';
 }
 
+size_t combo_box_style::get_size() const
+{
+	return sizeof(combo_box_style);
+}
+
 //
 // color picker style definitions
 //
@@ -351,6 +403,11 @@ std::string color_picker_style::to_string(uint16_t indent_amt) const
 		brace_str + '}';
 }
 
+size_t color_picker_style::get_size() const
+{
+	return sizeof(color_picker_style);
+}
+
 bool color_picker_style::operator==(const color_picker_style& other) const
 {
 	return !memcmp(this, &other, sizeof(color_picker_style));
@@ -390,4 +447,9 @@ std::string color_editor_style::to_string(uint16_t indent_amt) const
 		bg.to_string(indent_amt + 1) + ",\n" +
 		brace_str + '}';
 	
+}
+
+size_t color_editor_style::get_size() const
+{
+	return sizeof(color_editor_style);
 }
\ No newline at end of file
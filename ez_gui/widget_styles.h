@@ -17,6 +17,12 @@ struct style
 	style(const std::string& name);
 
 	virtual std::string to_string(uint16_t indent_amt = 1) const;
+
+	// get the size of the most derived style, used to find out which style a pointer to a style field belongs to
+	virtual size_t get_size() const;
+
+	// check if a pointer points into this style, like a widget that is bound to one of the style's fields
+	bool contains(const void* p_field) const;
 };
 
 // widget text styling
@@ -34,6 +40,7 @@ struct text_style : style
 
 	// return string with styles required code
 	std::string to_string(uint16_t indent_amt = 1) const; 
+	size_t get_size() const override;
 };
 
 // widget border styling
@@ -50,6 +57,7 @@ struct border_style : style
 
 	// print out the style's required code
 	std::string to_string(uint16_t indent_amt = 1) const;
+	size_t get_size() const override;
 };
 
 // multicolored rect, usually used for backgrounds or rects with gradients
@@ -66,6 +74,7 @@ struct mc_rect : style
 
 	// print out the style's required code
 	std::string to_string(uint16_t indent_amt = 1) const;
+	size_t get_size() const override;
 };
 
 //
@@ -84,6 +93,7 @@ struct checkbox_style : style
 	checkbox_style(const text_style& text, const border_style& border, const mc_rect& bg, const mc_rect& check, float gap);
 
 	std::string to_string(uint16_t indent_amt = 1) const;
+	size_t get_size() const override;
 };
 
 struct button_style : style
@@ -96,6 +106,7 @@ struct button_style : style
 	button_style(const text_style& text, const border_style& border, const mc_rect& bg);
 
 	std::string to_string(uint16_t indent_amt = 1) const;
+	size_t get_size() const override;
 };
 
 struct slider_style : style
@@ -109,6 +120,7 @@ struct slider_style : style
 	slider_style(const text_style& text, const border_style& border, const mc_rect& bg, const mc_rect& clr);
 
 	std::string to_string(uint16_t indent_amt = 1) const;
+	size_t get_size() const override;
 } inline default_slider_style{};
 
 struct text_entry_style : style
@@ -123,6 +135,7 @@ struct text_entry_style : style
 	text_entry_style(const text_style& text, const text_style& buf_text, const border_style& border, const mc_rect& bg);
 
 	std::string to_string(uint16_t indent_amt = 1) const;
+	size_t get_size() const override;
 };
 
 struct combo_box_style : style
@@ -136,6 +149,7 @@ struct combo_box_style : style
 	combo_box_style(const text_style& text, const border_style& border, const mc_rect& bg);
 
 	std::string to_string(uint16_t indent_amt = 1) const;
+	size_t get_size() const override;
 };
 
 struct color_picker_style : style
@@ -151,6 +165,7 @@ struct color_picker_style : style
 	color_picker_style(const text_style& text, const border_style& border, const mc_rect& bg, const border_style& sldr_border, float sldr_gap);
 
 	std::string to_string(uint16_t indent_amt = 1) const;
+	size_t get_size() const override;
 
 	bool operator==(const color_picker_style&) const;
 	bool operator!=(const color_picker_style&) const;
@@ -166,4 +181,5 @@ struct color_editor_style : style
 	color_editor_style(const text_style& text, const border_style& border, const mc_rect& bg);
 
 	std::string to_string(uint16_t indent_amt = 1) const;
+	size_t get_size() const override;
 };
\ No newline at end of file
@@ -18,17 +18,249 @@ mouse_state::mouse_state(const vec2& click_origin) :
 widget_input::widget_input(const vec2& m_pos) :
 	type(input_type::mouse_move),
 	m_pos(m_pos),
-	key(0)
+	key(0),
+	time(input_clock::now())
 { }
 
 widget_input::widget_input(char key) :
 	type(input_type::key_press),
 	m_pos({ 0.f, 0.f }),
-	key(0)
+	key(key),
+	time(input_clock::now())
 { }
 
 widget_input::widget_input(input_type type, const vec2& m_pos) :
 	type(type),
 	m_pos(m_pos),
-	key(0)
-{ }
\ No newline at end of file
+	key(0),
+	time(input_clock::now())
+{ }
+
+//
+// input channel definitions
+//
+
+input_channel::input_channel() :
+	ring(),
+	backlog(),
+	coalesced_count(0),
+	dropped_count(0)
+{
+	// the backlog is filled on the producer thread, so it never allocates after this
+	backlog.reserve(INPUT_BACKLOG_CAPACITY);
+}
+
+void input_channel::push(const widget_input& msg)
+{
+	flush();
+
+	// anything already waiting in the backlog has to be received first
+	if (backlog.empty() && ring.push(msg))
+		return;
+
+	if (msg.type == input_type::mouse_move && !backlog.empty() && backlog.back().type == input_type::mouse_move)
+	{
+		backlog.back().m_pos = msg.m_pos;
+		coalesced_count.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	if (backlog.size() == INPUT_BACKLOG_CAPACITY)
+	{
+		// a mouse move only matters for the position it carries, clicks and key presses carry their own, so the oldest move goes first
+		auto oldest_move = std::find_if(backlog.begin(), backlog.end(), [](const widget_input& queued) { return queued.type == input_type::mouse_move; });
+
+		if (oldest_move != backlog.end())
+		{
+			backlog.erase(oldest_move);
+			coalesced_count.fetch_add(1, std::memory_order_relaxed);
+		}
+		else
+		{
+			// the backlog is nothing but clicks and key presses, the new message is the one that gets lost
+			if (msg.type == input_type::mouse_move)
+				coalesced_count.fetch_add(1, std::memory_order_relaxed);
+			else
+				dropped_count.fetch_add(1, std::memory_order_relaxed);
+
+			return;
+		}
+	}
+
+	backlog.push_back(msg);
+}
+
+void input_channel::flush()
+{
+	auto moved = backlog.begin();
+	while (moved != backlog.end() && ring.push(*moved))
+		++moved;
+
+	backlog.erase(backlog.begin(), moved);
+}
+
+bool input_channel::pop(widget_input& msg)
+{
+	return ring.pop(msg);
+}
+
+size_t input_channel::size() const
+{
+	return ring.size();
+}
+
+size_t input_channel::take_coalesced_count()
+{
+	return coalesced_count.exchange(0, std::memory_order_relaxed);
+}
+
+size_t input_channel::take_dropped_count()
+{
+	return dropped_count.exchange(0, std::memory_order_relaxed);
+}
+
+//
+// worker pool definitions
+//
+
+worker_pool::worker_pool(size_t thread_count) :
+	threads(),
+	mutex(),
+	work_ready(),
+	work_done(),
+	p_task(nullptr),
+	task_count(0),
+	next_task(0),
+	busy_count(0),
+	batch(0),
+	stopping(false)
+{
+	for (auto i = 0u; i < thread_count; ++i)
+		threads.emplace_back(&worker_pool::worker_loop, this);
+}
+
+worker_pool::~worker_pool()
+{
+	{
+		std::lock_guard lock{ mutex };
+		stopping = true;
+	}
+
+	work_ready.notify_all();
+
+	for (auto& thread : threads)
+		thread.join();
+}
+
+void worker_pool::run(size_t task_count, const std::function<void(size_t)>& task)
+{
+	// waking the workers is not worth it for a single task
+	if (threads.empty() || task_count <= 1)
+	{
+		for (auto i = 0u; i < task_count; ++i)
+			task(i);
+
+		return;
+	}
+
+	{
+		std::lock_guard lock{ mutex };
+		p_task = &task;
+		this->task_count = task_count;
+		next_task = 0;
+		busy_count = threads.size();
+		batch++;
+	}
+
+	work_ready.notify_all();
+	work();
+
+	std::unique_lock lock{ mutex };
+	work_done.wait(lock, [this]() { return busy_count == 0; });
+	p_task = nullptr;
+}
+
+size_t worker_pool::get_thread_count() const
+{
+	return threads.size() + 1;
+}
+
+void worker_pool::worker_loop()
+{
+	uint64_t finished_batch = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock lock{ mutex };
+			work_ready.wait(lock, [&]() { return stopping || batch != finished_batch; });
+
+			if (stopping)
+				return;
+
+			finished_batch = batch;
+		}
+
+		work();
+
+		std::lock_guard lock{ mutex };
+		if (--busy_count == 0)
+			work_done.notify_one();
+	}
+}
+
+void worker_pool::work()
+{
+	for (auto i = next_task++; i < task_count; i = next_task++)
+		(*p_task)(i);
+}
+
+//
+// widget arena definitions
+//
+
+widget_arena::widget_arena(size_t block_size) :
+	blocks(),
+	destructors(),
+	block_size(block_size),
+	bytes_used(0)
+{ }
+
+widget_arena::~widget_arena()
+{
+	for (auto it = destructors.rbegin(); it != destructors.rend(); ++it)
+		it->p_destroy(it->p_object);
+}
+
+size_t widget_arena::get_bytes_used() const
+{
+	return bytes_used;
+}
+
+size_t widget_arena::get_block_count() const
+{
+	return blocks.size();
+}
+
+void* widget_arena::allocate(size_t size, size_t alignment)
+{
+	if (!blocks.empty())
+	{
+		auto& current = blocks.back();
+		auto address = reinterpret_cast<uintptr_t>(current.p_data.get()) + current.used;
+		auto padding = (alignment - address % alignment) % alignment;
+
+		if (current.used + padding + size <= current.size)
+		{
+			current.used += padding + size;
+			bytes_used += padding + size;
+			return reinterpret_cast<void*>(address + padding);
+		}
+	}
+
+	// objects bigger than a block get a block of their own size
+	auto new_size = (std::max)(block_size, size + alignment);
+	blocks.push_back({ std::make_unique<std::byte[]>(new_size), new_size, 0 });
+
+	return allocate(size, alignment);
+}
\ No newline at end of file
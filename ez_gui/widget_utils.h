@@ -1,9 +1,28 @@
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 
 #include "../dx11_renderer/renderer_utils.h"
 
+#define INPUT_RING_CAPACITY 256
+#define INPUT_BACKLOG_CAPACITY 64
+#define WIDGET_ARENA_BLOCK_SIZE 0x10000
+#define PARALLEL_DRAW_MIN_WIDGETS 128
+#define PARALLEL_DRAW_THREADS 0
+
 //
 // widget utilities
 //
@@ -49,7 +68,8 @@ struct mouse_state
 			uint8_t clicked : 1;  // if a widget was clicked
 			uint8_t clicking : 1; // if a widget is being clicked
 			uint8_t hovering : 1; // if a widget is being hovered
-			uint8_t reserved : 5;
+			uint8_t focused : 1;  // if a widget owns the keyboard focus of its list
+			uint8_t reserved : 4;
 		};
 	};
 
@@ -65,15 +85,200 @@ enum class input_type
 	key_press
 };
 
+// clock used to timestamp input messages
+using input_clock = std::chrono::steady_clock;
+
 // widget input messages that come from a mouse/kybd hook or wndproc
 struct widget_input
 {
-	input_type type; // type of the input
-	vec2 m_pos;		 // position of the mouse
-	char key;		 // key that was pressed
+	input_type type;		   // type of the input
+	vec2 m_pos;				   // position of the mouse
+	char key;				   // key that was pressed
+	input_clock::time_point time; // when the message was created, coalesced mouse moves keep the time of the oldest move
 
 	widget_input() = delete;
 	widget_input(const vec2& m_pos);
 	widget_input(char key);
 	widget_input(input_type type, const vec2& m_pos);
-};
\ No newline at end of file
+};
+
+// bounded lock free ring for exactly one producer thread and one consumer thread, push never blocks and fails when the ring is full
+template <typename Ty, size_t capacity>
+class spsc_ring
+{
+	static_assert((capacity & (capacity - 1)) == 0, "spsc_ring - capacity must be a power of two");
+	static_assert(std::is_trivially_copyable<Ty>::value, "spsc_ring - Ty must be trivially copyable");
+
+public:
+	spsc_ring() :
+		head(0),
+		tail(0)
+	{ }
+
+	spsc_ring(const spsc_ring&) = delete;
+
+	// producer only, copy value into the ring, returns false if the ring is full
+	bool push(const Ty& value)
+	{
+		auto tail_pos = tail.load(std::memory_order_relaxed);
+		if (tail_pos - head.load(std::memory_order_acquire) == capacity)
+			return false;
+
+		new (&slots[(tail_pos & (capacity - 1)) * sizeof(Ty)]) Ty(value);
+		tail.store(tail_pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	// consumer only, copy the oldest value out of the ring, returns false if the ring is empty
+	bool pop(Ty& value)
+	{
+		auto head_pos = head.load(std::memory_order_relaxed);
+		if (head_pos == tail.load(std::memory_order_acquire))
+			return false;
+
+		value = *std::launder(reinterpret_cast<Ty*>(&slots[(head_pos & (capacity - 1)) * sizeof(Ty)]));
+		head.store(head_pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	// amount of values in the ring, only exact when called from the consumer while the producer is idle
+	size_t size() const
+	{
+		return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+	}
+
+private:
+	// head and tail are written by different threads, so they get their own cache lines
+	alignas(64) std::atomic<size_t> head; // next slot the consumer reads
+	alignas(64) std::atomic<size_t> tail; // next slot the producer writes
+	alignas(Ty) std::byte slots[capacity * sizeof(Ty)];
+};
+
+// input channel from the thread that receives window messages to the thread that draws widgets
+// when the ring is full messages wait in a bounded backlog on the producer side where mouse moves get coalesced
+// the backlog is allocated once, so the producer never blocks or allocates, when it is full the oldest mouse move is dropped to make room
+class input_channel
+{
+public:
+	input_channel();
+
+	// producer only, send a message to the consumer
+	void push(const widget_input& msg);
+
+	// producer only, move as much of the backlog into the ring as fits
+	// push does this first on its own, the producer also has to call it once per message loop so the backlog drains without new input
+	void flush();
+
+	// consumer only, receive the oldest message, returns false if there is none
+	bool pop(widget_input& msg);
+
+	// consumer only, amount of messages ready to be received
+	size_t size() const;
+
+	// get and reset the amount of mouse moves that were coalesced or dropped in the backlog
+	size_t take_coalesced_count();
+
+	// get and reset the amount of clicks and key presses that were dropped because the backlog was full of them
+	size_t take_dropped_count();
+
+private:
+	spsc_ring<widget_input, INPUT_RING_CAPACITY> ring;
+	std::vector<widget_input> backlog;	 // producer side overflow in order, only used while the ring is full, never grows past INPUT_BACKLOG_CAPACITY
+	std::atomic<size_t> coalesced_count; // mouse moves merged or dropped in the backlog
+	std::atomic<size_t> dropped_count;	 // clicks and key presses dropped from the backlog
+};
+
+// input queue counters of a widget list, used to track input latency
+struct input_stats
+{
+	size_t queue_depth;		// amount of messages that were waiting when the queue was last drained
+	size_t coalesced_count;	// amount of mouse moves that were merged into a newer move before the queue was last drained
+	size_t dropped_count;	// amount of clicks and key presses that were lost because the queue was full before it was last drained
+	float input_age;		// milliseconds the oldest message waited in the queue before it was handled
+};
+
+// monotonic allocator that keeps objects next to each other in large blocks, everything is destroyed and freed at once with the arena
+// objects can not be freed on their own, so it is meant for things that live as long as their owner like the widgets of a list
+class widget_arena
+{
+public:
+	widget_arena(size_t block_size = WIDGET_ARENA_BLOCK_SIZE);
+	widget_arena(const widget_arena&) = delete;
+	~widget_arena();
+
+	// construct an object in the arena, the pointer stays valid until the arena is destroyed
+	template <typename Ty, typename... Args>
+	Ty* create(Args&&... args)
+	{
+		auto p_object = new (allocate(sizeof(Ty), alignof(Ty))) Ty(std::forward<Args>(args)...);
+
+		if constexpr (!std::is_trivially_destructible_v<Ty>)
+			destructors.push_back({ p_object, [](void* p) { static_cast<Ty*>(p)->~Ty(); } });
+
+		return p_object;
+	}
+
+	// get the amount of bytes handed out, including alignment padding
+	size_t get_bytes_used() const;
+
+	// get the amount of blocks the arena allocated
+	size_t get_block_count() const;
+
+private:
+	struct block
+	{
+		std::unique_ptr<std::byte[]> p_data;
+		size_t size;
+		size_t used;
+	};
+
+	// an object that has to be destroyed with the arena
+	struct destructor
+	{
+		void* p_object;
+		void(*p_destroy)(void*);
+	};
+
+	std::vector<block> blocks;
+	std::vector<destructor> destructors; // destroyed in reverse order of creation
+	size_t block_size;
+	size_t bytes_used;
+
+	// get aligned memory from the current block, a new block is started if it does not fit
+	void* allocate(size_t size, size_t alignment);
+};
+
+// threads that are started once and then run batches of tasks, so work can be spread every frame without starting threads every frame
+// the calling thread works on a batch as well, a pool with 0 threads runs everything on the calling thread
+class worker_pool
+{
+public:
+	worker_pool(size_t thread_count);
+	worker_pool(const worker_pool&) = delete;
+	~worker_pool();
+
+	// call task(i) for every i below task_count on the workers and the calling thread, returns once every task is done
+	// tasks are handed out one at a time, so a long task does not hold up a fixed share of the others
+	void run(size_t task_count, const std::function<void(size_t)>& task);
+
+	// get the amount of threads a batch runs on, including the calling thread
+	size_t get_thread_count() const;
+
+private:
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable work_ready; // signaled when a batch starts or the pool is stopping
+	std::condition_variable work_done;	// signaled when the last worker finished its part of a batch
+	const std::function<void(size_t)>* p_task; // task of the current batch
+	size_t task_count;					// amount of tasks in the current batch
+	std::atomic<size_t> next_task;		// next task of the current batch that nobody took yet
+	size_t busy_count;					// workers that did not finish the current batch yet
+	uint64_t batch;						// bumped for every batch, so workers can tell a new batch from the one they finished
+	bool stopping;
+
+	// wait for batches until the pool is destroyed
+	void worker_loop();
+
+	// take tasks of the current batch until none are left
+	void work();
+};
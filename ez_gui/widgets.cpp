@@ -11,7 +11,9 @@ widget::widget(const vec2& top_left, const vec2& size, const std::wstring& label
 	label_pos({size.x, 0.f}),
 	p_style(nullptr),
 	mouse_info({ 0.f, 0.f }),
-	active(true)
+	active(true),
+	dirty(true),
+	geometry()
 { }
 
 widget::widget(const vec2& top_left, const vec2& size, const std::wstring& label, style* p_style) :
@@ -21,7 +23,9 @@ widget::widget(const vec2& top_left, const vec2& size, const std::wstring& label
 	label_pos({ size.x, 0.f }),
 	p_style(p_style),
 	mouse_info({ 0.f, 0.f }),
-	active(true)
+	active(true),
+	dirty(true),
+	geometry()
 { }
 
 widget::widget(const vec2& top_left, const vec2& size, const std::wstring& label, const vec2& label_pos) :
@@ -31,7 +35,9 @@ widget::widget(const vec2& top_left, const vec2& size, const std::wstring& label
 	label_pos(label_pos),
 	p_style(nullptr),
 	mouse_info({ 0.f, 0.f }),
-	active(true)
+	active(true),
+	dirty(true),
+	geometry()
 { }
 
 widget::widget(const vec2& top_left, const vec2& size, const std::wstring& label, const vec2& label_pos, style* p_style) :
@@ -41,12 +47,40 @@ widget::widget(const vec2& top_left, const vec2& size, const std::wstring& label
 	label_pos(label_pos),
 	p_style(p_style),
 	mouse_info({ 0.f, 0.f }),
-	active(true)
+	active(true),
+	dirty(true),
+	geometry()
 { }
 
 void widget::set_style(style* p_style)
 {
 	this->p_style = p_style;
+	dirty = true;
+}
+
+void widget::mark_dirty()
+{
+	dirty = true;
+}
+
+bool widget::is_dirty()
+{
+	return dirty || value_changed();
+}
+
+bool widget::value_changed()
+{
+	return false;
+}
+
+const void* widget::get_value_ptr()
+{
+	return nullptr;
+}
+
+void widget::clear_dirty()
+{
+	dirty = false;
 }
 
 bool widget::contains(const vec2& pos)
@@ -62,6 +96,37 @@ vec2 widget::relative_position(const vec2& pos)
 	return pos - top_left;
 }
 
+region widget::get_draw_extent()
+{
+	region extent{ top_left, size };
+	if (label.empty())
+		return extent;
+
+	// union with the box the label is laid out in
+	auto label_tl = top_left + label_pos;
+	auto min_x = (std::min)(extent.top_left.x, label_tl.x);
+	auto min_y = (std::min)(extent.top_left.y, label_tl.y);
+	auto max_x = (std::max)(extent.top_left.x + extent.size.x, label_tl.x + size.x);
+	auto max_y = (std::max)(extent.top_left.y + extent.size.y, label_tl.y + size.y);
+
+	return { { min_x, min_y }, { max_x - min_x, max_y - min_y } };
+}
+
+region widget::merge_text_extent(const region& extent, const vec2& pos, const std::wstring& text, const text_style& style)
+{
+	if (text.empty())
+		return extent;
+
+	// the background is drawn one pixel wider than the text and the outline reaches outside of it on every side
+	auto text_size = p_renderer->measure_text(text, style.size);
+	auto min_x = (std::min)(extent.top_left.x, pos.x - style.ol_thckns);
+	auto min_y = (std::min)(extent.top_left.y, pos.y - style.ol_thckns);
+	auto max_x = (std::max)(extent.top_left.x + extent.size.x, pos.x + text_size.x + style.ol_thckns + 1.f);
+	auto max_y = (std::max)(extent.top_left.y + extent.size.y, pos.y + text_size.y + style.ol_thckns);
+
+	return { { min_x, min_y }, { max_x - min_x, max_y - min_y } };
+}
+
 void widget::draw() 
 { 
 	std::cout << "base draw called" << std::endl;
@@ -97,6 +162,11 @@ void widget::on_widget_move(const vec2& new_position)
 void widget::on_key_down(char key) 
 { }
 
+bool widget::is_focusable()
+{
+	return false;
+}
+
 std::string widget::to_string(uint16_t indent_amt)
 {
 	return "";
@@ -113,12 +183,14 @@ widget_type widget::get_type()
 
 checkbox::checkbox(const vec2& top_left, const vec2& size, const std::wstring& label, bool* value, checkbox_style* style) :
 	widget( top_left, size, label, style),
-	value(value)
+	value(value),
+	drawn_value(false)
 { }
 
 checkbox::checkbox(const vec2& top_left, const vec2& size, const std::wstring& label, const vec2& label_pos, bool* value, checkbox_style* style) :
 	widget( top_left, size, label, label_pos, style),
-	value(value)
+	value(value),
+	drawn_value(false)
 { }
 
 void checkbox::on_lbutton_up(const vec2& mouse_position)
@@ -131,9 +203,35 @@ void checkbox::on_lbutton_up(const vec2& mouse_position)
 	}
 }
 
+bool checkbox::value_changed()
+{
+	return value != nullptr && *value != drawn_value;
+}
+
+const void* checkbox::get_value_ptr()
+{
+	return value;
+}
+
+void checkbox::clear_dirty()
+{
+	dirty = false;
+	if (value != nullptr)
+		drawn_value = *value;
+}
+
+region checkbox::get_draw_extent()
+{
+	return merge_text_extent(widget::get_draw_extent(), top_left + label_pos, label, static_cast<checkbox_style*>(p_style)->text);
+}
+
 void checkbox::draw()
 {
-	auto style = static_cast<checkbox_style*>(p_style);
+	draw_geometry(top_left, size, label_pos, label, *value, static_cast<checkbox_style*>(p_style));
+}
+
+void checkbox::draw_geometry(const vec2& top_left, const vec2& size, const vec2& label_pos, const std::wstring& label, bool checked, const checkbox_style* style)
+{
 	// add checkbox background
 	p_renderer->add_rect_filled_multicolor(top_left, size, style->bg.tl_clr, style->bg.tr_clr, style->bg.bl_clr, style->bg.br_clr);
 
@@ -144,7 +242,7 @@ void checkbox::draw()
 	p_renderer->add_outlined_text_with_bg(top_left + label_pos, size, label, style->text.clr, style->text.ol_clr, style->text.bg_clr, style->text.size, style->text.ol_thckns);
 
 	// if value is true, add rect inside
-	if (*value)
+	if (checked)
 		p_renderer->add_rect_filled_multicolor(top_left + label_pos, size - (style->gap * 2.f), style->check.tl_clr, style->check.tr_clr, style->check.bl_clr , style->check.br_clr);
 }
 
@@ -159,8 +257,9 @@ std::string checkbox::to_string(uint16_t indent_amt)
 	std::string brace_str(indent_amt > 0 ? indent_amt - 1 : 0, '\t');
 
 	return brace_str + "checkbox" + '\n' + brace_str + "{\n" +
-		tab_str + top_left.to_string() + ", " + size.to_string() + "\n" +
-		tab_str + "L\"" + std::string(label.begin(), label.end()) + "\"," + label_pos.to_string() + "\n,/*VALUE PTR HERE*/nullptr, nullptr\n" +
+		tab_str + top_left.to_string() + ", " + size.to_string() + ",\n" +
+		tab_str + "L\"" + std::string(label.begin(), label.end()) + "\"," + label_pos.to_string() + ",\n" +
+		tab_str + "/*VALUE PTR HERE*/nullptr, nullptr\n" +
 		brace_str + '}';
 }
 
@@ -241,6 +340,19 @@ void text_entry::on_key_down(char key)
 	}
 }
 
+bool text_entry::is_focusable()
+{
+	return true;
+}
+
+region text_entry::get_draw_extent()
+{
+	auto style = static_cast<text_entry_style*>(p_style);
+	auto extent = merge_text_extent(widget::get_draw_extent(), top_left + label_pos, label, style->text);
+
+	return merge_text_extent(extent, top_left + buffer_offset, buffer, style->buf_text);
+}
+
 void text_entry::draw()
 {
 	auto style = static_cast<text_entry_style*>(p_style);
@@ -286,11 +398,24 @@ combo_box::combo_box(const vec2& top_left, const vec2& size, const std::wstring&
 	widget(top_left, size, label, label_pos, style)
 { }
 
+region combo_box::get_draw_extent()
+{
+	// the label sits on the top border, half of it above the box
+	auto style = static_cast<combo_box_style*>(p_style);
+	return merge_text_extent({ top_left, size }, get_label_top_left(), label, style->text);
+}
+
 void combo_box::draw()
 {
 	auto style = static_cast<combo_box_style*>(p_style);
 	p_renderer->add_outlined_frame(top_left, size, style->border.thckns, style->border.ol_thckns, style->border.clr, style->border.ol_clr);
-	p_renderer->add_outlined_text_with_bg({ top_left.x + label_pos.x, top_left.y - style->text.size / 2.f - style->text.ol_thckns + label_pos.y }, size, label, style->text.clr, style->text.ol_clr, style->text.bg_clr, style->text.size);
+	p_renderer->add_outlined_text_with_bg(get_label_top_left(), size, label, style->text.clr, style->text.ol_clr, style->text.bg_clr, style->text.size);
+}
+
+vec2 combo_box::get_label_top_left()
+{
+	auto style = static_cast<combo_box_style*>(p_style);
+	return { top_left.x + label_pos.x, top_left.y - style->text.size / 2.f - style->text.ol_thckns + label_pos.y };
 }
 
 widget_type combo_box::get_type()
@@ -316,6 +441,7 @@ std::string combo_box::to_string(uint16_t indent_amt)
 color_picker::color_picker(const vec2& top_left, const vec2& size, const std::wstring& label, color_picker_style* style) :
 	widget(top_left, size, label, style),
 	p_color(nullptr),
+	drawn_color(),
 	active_slider_index(-1),
 	rgba_slider_size()
 {
@@ -326,6 +452,7 @@ color_picker::color_picker(const vec2& top_left, const vec2& size, const std::ws
 color_picker::color_picker(const vec2& top_left, const vec2& size, const std::wstring& label, color* p_color, color_picker_style* style) :
 	widget(top_left, size, label, style),
 	p_color(p_color),
+	drawn_color(),
 	active_slider_index(-1),
 	rgba_slider_size()
 {
@@ -336,6 +463,7 @@ color_picker::color_picker(const vec2& top_left, const vec2& size, const std::ws
 color_picker::color_picker(const vec2& top_left, const vec2& size, const std::wstring& label, const vec2& label_pos, color* p_color, color_picker_style* style) :
 	widget(top_left, size, label, label_pos, style),
 	p_color(p_color),
+	drawn_color(),
 	active_slider_index(-1),
 	rgba_slider_size()
 {
@@ -346,6 +474,7 @@ color_picker::color_picker(const vec2& top_left, const vec2& size, const std::ws
 void color_picker::set_style(style* p_new_style)
 {
 	p_style = p_new_style;
+	dirty = true;
 
 	// recalculate position and sizes when new style applied
 	calc_pos_and_sizes();
@@ -372,6 +501,7 @@ void color_picker::calc_pos_and_sizes()
 void color_picker::set_color_ptr(color* p_color)
 {
 	this->p_color = p_color;
+	dirty = true;
 }
 
 int color_picker::slider_click_index(const vec2& relative_mouse_pos) const
@@ -437,6 +567,23 @@ void color_picker::on_drag(const vec2& new_position)
 	}
 }
 
+bool color_picker::value_changed()
+{
+	return p_color != nullptr && !(*p_color == drawn_color);
+}
+
+const void* color_picker::get_value_ptr()
+{
+	return p_color;
+}
+
+void color_picker::clear_dirty()
+{
+	dirty = false;
+	if (p_color != nullptr)
+		drawn_color = *p_color;
+}
+
 void color_picker::draw()
 {
 	if (p_color == nullptr)
@@ -513,6 +660,8 @@ std::string color_picker::to_string(uint16_t indent_amt)
 
 color_editor::color_editor(const vec2& top_left, const vec2& size, const std::wstring& label, color_editor_style* style)
 	: widget(top_left, size, label, style)
+	, p_color(nullptr)
+	, drawn_color()
 	, slider_pct(0.f)
 	, alpha_pct(1.f)
 	, hsv_val()
@@ -521,6 +670,7 @@ color_editor::color_editor(const vec2& top_left, const vec2& size, const std::ws
 color_editor::color_editor(const vec2& top_left, const vec2& size, const std::wstring& label, color* p_color, color_editor_style* style)
 	: widget(top_left, size, label, style)
 	, p_color(p_color)
+	, drawn_color()
 {
 	hsv_val = p_color->to_hsv();
 	alpha_pct = p_color->a;
@@ -636,6 +786,23 @@ void color_editor::on_drag(const vec2& new_position)
 		update_color();
 }
 
+bool color_editor::value_changed()
+{
+	return p_color != nullptr && !(*p_color == drawn_color);
+}
+
+const void* color_editor::get_value_ptr()
+{
+	return p_color;
+}
+
+void color_editor::clear_dirty()
+{
+	dirty = false;
+	if (p_color != nullptr)
+		drawn_color = *p_color;
+}
+
 void color_editor::draw()
 {
 	if (!p_style || !p_color)
@@ -658,8 +825,8 @@ void color_editor::draw()
 
 	const region hsv_rgn{abs_hsv_tl, hsv_size };
 	const vec2 hsv_circle_center{ top_left.x + hsv_val.s * hsv_size.x, top_left.y + (1.f - hsv_val.v) * hsv_size.y };
-	p_renderer->add_clipped_circle(hsv_rgn, hsv_circle_center, size.y * .025f, colors::black, 32);
-	p_renderer->add_clipped_circle(hsv_rgn, hsv_circle_center, size.y * .03f, colors::white, 32);
+	p_renderer->add_clipped_circle(hsv_rgn, hsv_circle_center, size.y * .025f, colors::black);
+	p_renderer->add_clipped_circle(hsv_rgn, hsv_circle_center, size.y * .03f, colors::white);
 
 	// draw alpha slider
 	const auto alpha_sldr_size = get_alpha_sldr_size();
@@ -20,6 +20,8 @@ struct widget
 	style* p_style;         // pointer to the widgets style struct
 	mouse_state mouse_info; // widget mouse information (dragged, clicked, hovered, clicking, etc.)
 	bool active;			// disable functionality of a widget
+	bool dirty;				// the widget changed since it was last drawn
+	geometry_cache geometry;		// geometry of the last draw, added again instead of drawing while the widget is clean
 
 	inline static renderer* p_renderer;
 	inline static void set_renderer(renderer* p_instance)
@@ -73,9 +75,31 @@ struct widget
 	// set the widgets style pointer
 	virtual void set_style(style* p_style);
 
+	// flag the widget as changed so the next frame gets drawn, needed after changing a widget or its style from code
+	void mark_dirty();
+
+	// check if the widget changed since it was last drawn
+	bool is_dirty();
+
+	// check if the value a widget is bound to changed since it was last drawn
+	virtual bool value_changed();
+
+	// get the value the widget is bound to, nullptr if it is not bound to one
+	virtual const void* get_value_ptr();
+
+	// reset the dirty state after the widget was drawn
+	virtual void clear_dirty();
+
 	// determine if an widget contains a position
 	bool contains(const vec2& pos);
 
+	// get the region everything the widget draws fits in, the widget bounds and the box its label is laid out in by default
+	// pooled drawing keeps widgets whose extents overlap in separate layers, so widgets drawing outside of that box override this
+	virtual region get_draw_extent();
+
+	// grow an extent to cover a text drawn at pos with a text style, outline and background included
+	static region merge_text_extent(const region& extent, const vec2& pos, const std::wstring& text, const text_style& style);
+
 	// get relative position from the top_left of the widget
 	vec2 relative_position(const vec2& pos);
 
@@ -90,6 +114,9 @@ struct widget
 	virtual void on_key_down(char key);
 	virtual std::string to_string(uint16_t indent_amt);
 
+	// if the widget takes keyboard input, only focusable widgets can own the keyboard focus of a list
+	virtual bool is_focusable();
+
 	// virtual widget type function
 	virtual widget_type get_type();
 };
@@ -98,14 +125,22 @@ struct widget
 struct checkbox : widget
 {
 	bool* value;
+	bool drawn_value; // value when the checkbox was last drawn
 
 	checkbox() = delete;
 	checkbox(const vec2& top_left, const vec2& size, const std::wstring& label, bool* value, checkbox_style* style);
 	checkbox(const vec2& top_left, const vec2& size, const std::wstring& label, const vec2& label_pos, bool* value, checkbox_style* style);
 	void on_lbutton_up(const vec2& mouse_position);
+	bool value_changed() override;
+	const void* get_value_ptr() override;
+	void clear_dirty() override;
+	region get_draw_extent() override;
 	void draw() override;
 	widget_type get_type() override;
 
+	// add the geometry of a checkbox, shared by draw() and pooled drawing
+	static void draw_geometry(const vec2& top_left, const vec2& size, const vec2& label_pos, const std::wstring& label, bool checked, const checkbox_style* style);
+
 	std::string to_string(uint16_t indent_amt);
 };
 
@@ -129,24 +164,28 @@ struct slider : widget
 	Ty* value;
 	Ty min_value;
 	Ty max_value;
+	Ty drawn_value; // value when the slider was last drawn
 
 	slider(const vec2& top_left, const vec2& size, const std::wstring& label, Ty* value, Ty min, Ty max, slider_style* style) :
 		widget(top_left, size, label, style),
 		value(value),
 		min_value(min),
-		max_value(max)
+		max_value(max),
+		drawn_value()
 	{ }
 	slider(const vec2& top_left, const vec2& size, const std::wstring& label, Ty min, Ty max, slider_style* style) :
 		widget(top_left, size, label, style),
 		value(nullptr),
 		min_value(min),
-		max_value(max)
+		max_value(max),
+		drawn_value()
 	{ }
 	slider(const vec2& top_left, const vec2& size, const std::wstring& label, const vec2& label_pos, Ty* value, Ty min, Ty max, slider_style* style) :
 		widget(top_left, size, label, label_pos, style),
 		value(value),
 		min_value(min),
-		max_value(max)
+		max_value(max),
+		drawn_value()
 	{ }
 
 	Ty get_range()
@@ -157,6 +196,21 @@ struct slider : widget
 	void set_value_ptr(Ty* p_value)
 	{
 		value = p_value;
+		mark_dirty();
+	}
+	bool value_changed() override
+	{
+		return value != nullptr && *value != drawn_value;
+	}
+	const void* get_value_ptr() override
+	{
+		return value;
+	}
+	void clear_dirty() override
+	{
+		dirty = false;
+		if (value != nullptr)
+			drawn_value = *value;
 	}
 	void on_lbutton_down(const vec2& mouse_position) override
 	{
@@ -185,17 +239,26 @@ struct slider : widget
 		else if (std::is_floating_point_v<Ty>)
 			*value = static_cast<Ty>(get_range() * ratio + min_value);
 	}
+	region get_draw_extent() override
+	{
+		return merge_text_extent(widget::get_draw_extent(), top_left + label_pos, label, static_cast<slider_style*>(p_style)->text);
+	}
 	void draw() override
 	{
-		auto style = static_cast<slider_style*>(p_style);
-		// calculate the slider width
-		auto scaled_width = static_cast<float>(*value - min_value) / static_cast<float>(get_range()) * size.x;
+		// calculate how much of the slider is filled
+		auto ratio = static_cast<float>(*value - min_value) / static_cast<float>(get_range());
+
+		draw_geometry(top_left, size, label_pos, label, ratio, static_cast<slider_style*>(p_style));
+	}
 
+	// add the geometry of a slider filled to ratio, shared by draw() and pooled drawing
+	static void draw_geometry(const vec2& top_left, const vec2& size, const vec2& label_pos, const std::wstring& label, float ratio, const slider_style* style)
+	{
 		// add the background color
 		p_renderer->add_rect_filled_multicolor(top_left, size, style->bg.tl_clr, style->bg.tr_clr, style->bg.bl_clr, style->bg.br_clr);
 
 		// add the slider
-		p_renderer->add_rect_filled_multicolor(top_left, { scaled_width, size.y }, style->clr.tl_clr, style->clr.tr_clr, style->clr.bl_clr, style->clr.br_clr);
+		p_renderer->add_rect_filled_multicolor(top_left, { ratio * size.x, size.y }, style->clr.tl_clr, style->clr.tr_clr, style->clr.bl_clr, style->clr.br_clr);
 
 		// add the border
 		p_renderer->add_outlined_frame(top_left, size, style->border.thckns, style->border.ol_thckns, style->border.clr, style->border.ol_clr);
@@ -242,7 +305,9 @@ struct text_entry : widget
 	text_entry(const vec2& top_left, const vec2& size, const std::wstring& label, text_entry_style* style, uint32_t max_buffer_size = 128u, const vec2& buffer_offset = {0.f, 0.f});
 	text_entry(const vec2& top_left, const vec2& size, const std::wstring& label, const vec2& label_pos, text_entry_style* style, uint32_t max_buffer_size = 128u, const vec2& buffer_offset = { 0.f, 0.f });
 	
-	void on_key_down(char key);
+	void on_key_down(char key) override;
+	bool is_focusable() override;
+	region get_draw_extent() override;
 	void draw() override;
 
 	widget_type get_type() override;
@@ -257,17 +322,22 @@ struct combo_box : widget
 
 	combo_box(const vec2& top_left, const vec2& size, const std::wstring& label, const vec2& label_pos, combo_box_style* style);
 
+	region get_draw_extent() override;
 	void draw() override;
 
 	widget_type get_type() override;
 
 	std::string to_string(uint16_t indent_amt) override;
+
+	// get where the label is drawn, on the top border
+	vec2 get_label_top_left();
 };
 
 // edit a color with rgba sliders
 struct color_picker : widget
 {
 	color* p_color;
+	color drawn_color; // color when the picker was last drawn
 
 	float border_padding;
 	vec2 header_size;
@@ -292,6 +362,9 @@ struct color_picker : widget
 	void on_lbutton_down(const vec2& mouse_position) override;
 	void on_lbutton_up(const vec2& mouse_position) override;
 	void on_drag(const vec2& new_position) override;
+	bool value_changed() override;
+	const void* get_value_ptr() override;
+	void clear_dirty() override;
 	void draw() override;
 
 	widget_type get_type() override;
@@ -303,6 +376,7 @@ struct color_picker : widget
 struct color_editor : widget
 {
 	color* p_color;
+	color drawn_color; // color when the editor was last drawn
 	float slider_pct;
 	float alpha_pct;
 	vec2 hsv_circle_pos;
@@ -323,6 +397,9 @@ struct color_editor : widget
 
 	void on_lbutton_down(const vec2& mouse_pos) override;
 	void on_drag(const vec2& new_position) override;
+	bool value_changed() override;
+	const void* get_value_ptr() override;
+	void clear_dirty() override;
 	void draw() override;
 
 	widget_type get_type() const;
@@ -0,0 +1,291 @@
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <random>
+
+#include "tests.h"
+#include "../dx11_renderer/renderer.h"
+#include "../ez_gui/widget_utils.h"
+#include "../FW1FontWrapper/Source/CFW1Skyline.h"
+
+//
+// benchmarks, timings are printed and nothing is checked
+//
+
+// get the average time a frame took in microseconds
+template <typename Fn>
+static double time_frames(size_t frame_count, Fn&& frame)
+{
+	// the first frames grow the draw lists
+	for (auto i = 0; i < 4; ++i)
+		frame();
+
+	auto start = std::chrono::steady_clock::now();
+	for (auto i = 0u; i < frame_count; ++i)
+		frame();
+
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / frame_count;
+}
+
+// record what a list of sliders records apart from their labels, text needs a device
+static void record_list(renderer& renderer, size_t widget_count)
+{
+	for (auto i = 0u; i < widget_count; ++i)
+	{
+		vec2 top_left{ 10.f + (i % 8) * 150.f, 10.f + (i / 8) * 24.f };
+		renderer.add_rect_filled_multicolor(top_left, { 140.f, 20.f }, colors::gray, colors::gray, colors::black, colors::black);
+		renderer.add_rect_filled_multicolor(top_left, { 70.f, 20.f }, colors::white, colors::white, colors::gray, colors::gray);
+		renderer.add_outlined_frame(top_left, { 140.f, 20.f }, 1.f, 1.f, colors::black, colors::white);
+	}
+}
+
+// record widget lists serially, with threads started every frame and with a worker_pool, like globals::draw_widget_lists
+static void widget_list_recording_benchmark()
+{
+	constexpr size_t frame_count = 2000;
+	region viewport{ { 0.f, 0.f }, { 1920.f, 1080.f } };
+
+	renderer renderer;
+	draw_list frame_list;
+
+	auto thread_count = (std::max)(std::thread::hardware_concurrency(), 2u);
+	worker_pool workers{ thread_count - 1 };
+
+	std::printf("widget list recording, %u threads, microseconds per frame\n", thread_count);
+	std::printf("%8s %8s %10s %14s %12s\n", "lists", "widgets", "serial", "thread/frame", "worker_pool");
+
+	for (auto list_count : { 2u, 4u, 8u })
+	{
+		for (auto widget_count : { 8u, 64u, 512u })
+		{
+			std::vector<std::unique_ptr<draw_list>> lists;
+			for (auto i = 0u; i < list_count; ++i)
+				lists.push_back(std::make_unique<draw_list>());
+
+			// the renderer is not initialized, so its viewport is empty and the lists get a real one
+			auto record = [&](size_t idx)
+			{
+				renderer.set_thread_draw_list(lists[idx].get());
+				lists[idx]->set_viewport(viewport);
+				record_list(renderer, widget_count);
+				renderer.set_thread_draw_list(nullptr);
+			};
+
+			auto splice = [&]()
+			{
+				for (auto& list : lists)
+					frame_list.splice(*list);
+			};
+
+			auto serial = time_frames(frame_count, [&]()
+			{
+				frame_list.clear();
+				renderer.set_thread_draw_list(&frame_list);
+				frame_list.set_viewport(viewport);
+				for (auto i = 0u; i < list_count; ++i)
+					record_list(renderer, widget_count);
+				renderer.set_thread_draw_list(nullptr);
+			});
+
+			// what draw_widget_lists did before it took a worker_pool
+			auto threads = time_frames(frame_count, [&]()
+			{
+				frame_list.clear();
+
+				std::atomic<size_t> next_list = 0;
+				auto work = [&]()
+				{
+					for (auto idx = next_list++; idx < list_count; idx = next_list++)
+						record(idx);
+				};
+
+				std::vector<std::thread> started;
+				for (auto i = 1u; i < (std::min)(thread_count, list_count); ++i)
+					started.emplace_back(work);
+
+				work();
+
+				for (auto& thread : started)
+					thread.join();
+
+				splice();
+			});
+
+			auto pooled = time_frames(frame_count, [&]()
+			{
+				frame_list.clear();
+				workers.run(list_count, record);
+				splice();
+			});
+
+			std::printf("%8u %8u %10.1f %14.1f %12.1f\n", list_count, widget_count, serial, threads, pooled);
+		}
+	}
+}
+
+// the height per column packer glyph sheets used before CFW1Skyline, kept to compare against
+class column_packer
+{
+public:
+	column_packer(UINT total_width) :
+		heights(total_width, 0),
+		total_width(total_width)
+	{}
+
+	// find the x position where a rect of width gets the lowest top
+	UINT find_position(UINT width, UINT* p_y)
+	{
+		width = (std::min)(width, total_width);
+
+		auto current_max = find_max(0, width);
+		auto current_min = current_max;
+		UINT min_x = 0;
+
+		for (UINT i = 1; i < total_width - width; ++i)
+		{
+			if (heights[i + width - 1] >= current_max)
+				current_max = heights[i + width - 1];
+			else if (heights[i - 1] == current_max)
+			{
+				current_max = find_max(i, width);
+				if (current_max < current_min)
+				{
+					current_min = current_max;
+					min_x = i;
+				}
+			}
+		}
+
+		*p_y = current_min;
+		return min_x;
+	}
+
+	void add_rect(UINT start_x, UINT width, UINT new_height)
+	{
+		width = (std::min)(width, total_width);
+		for (UINT i = 0; i < width; ++i)
+			heights[start_x + i] = new_height;
+	}
+
+private:
+	std::vector<UINT> heights;
+	UINT total_width;
+
+	UINT find_max(UINT start_x, UINT width)
+	{
+		auto current_max = heights[start_x];
+		for (UINT i = 1; i < width; ++i)
+			current_max = (std::max)(current_max, heights[start_x + i]);
+
+		return current_max;
+	}
+};
+
+// the same calls under the names CFW1GlyphSheet uses
+class skyline_packer
+{
+public:
+	skyline_packer(UINT total_width) :
+		skyline(total_width)
+	{}
+
+	UINT find_position(UINT width, UINT* p_y)
+	{
+		return skyline.findPosition(width, p_y);
+	}
+
+	void add_rect(UINT start_x, UINT width, UINT new_height)
+	{
+		skyline.addRect(start_x, width, new_height);
+	}
+
+private:
+	FW1FontWrapper::CFW1Skyline skyline;
+};
+
+struct packing_result
+{
+	size_t sheet_count;
+	double occupancy;		   // glyph area over sheet area of every sheet that filled up
+	double insert_microseconds; // average time of an insert
+};
+
+// fill sheets with glyphs like CFW1GlyphSheet::InsertGlyph does without mip levels, a new sheet is started when a glyph does not fit
+template <typename Packer>
+static packing_result pack_glyphs(const std::vector<std::pair<UINT, UINT>>& glyph_sizes, UINT sheet_size, UINT max_glyph_count)
+{
+	std::vector<double> full_sheet_occupancy;
+	auto packer = std::make_unique<Packer>(sheet_size);
+	UINT glyph_count = 0, used_area = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (auto i = 0u; i < glyph_sizes.size(); ++i)
+	{
+		// glyphs are padded by a pixel on their right and bottom edges
+		auto block_width = glyph_sizes[i].first + 1;
+		auto block_height = glyph_sizes[i].second + 1;
+
+		UINT block_y = 0;
+		auto block_x = packer->find_position(block_width, &block_y);
+
+		if (glyph_count >= max_glyph_count || 1 + block_y + glyph_sizes[i].second + 1 > sheet_size)
+		{
+			full_sheet_occupancy.push_back(static_cast<double>(used_area) / (sheet_size * sheet_size));
+			packer = std::make_unique<Packer>(sheet_size);
+			glyph_count = used_area = 0;
+
+			block_x = packer->find_position(block_width, &block_y);
+		}
+
+		packer->add_rect(block_x, block_width, block_y + block_height);
+		used_area += block_width * block_height;
+		glyph_count++;
+	}
+
+	auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+	double occupancy = 0.0;
+	for (auto sheet_occupancy : full_sheet_occupancy)
+		occupancy += sheet_occupancy;
+
+	if (!full_sheet_occupancy.empty())
+		occupancy /= full_sheet_occupancy.size();
+
+	return { full_sheet_occupancy.size() + 1, occupancy, elapsed / glyph_sizes.size() };
+}
+
+// pack the same glyphs with the column packer and the skyline, mostly text sized glyphs with some large ones mixed in
+static void glyph_packing_benchmark()
+{
+	constexpr size_t glyph_count = 10000;
+	constexpr UINT sheet_size = 512;
+	constexpr UINT max_glyph_count = 2048;
+
+	std::mt19937 random{ 1234 };
+	std::uniform_int_distribution<UINT> text_width{ 4, 16 }, text_height{ 8, 22 }, large_size{ 24, 64 };
+	std::uniform_int_distribution<int> percent{ 0, 99 };
+
+	std::vector<std::pair<UINT, UINT>> glyph_sizes;
+	for (auto i = 0u; i < glyph_count; ++i)
+	{
+		if (percent(random) < 10)
+			glyph_sizes.emplace_back(large_size(random), large_size(random));
+		else
+			glyph_sizes.emplace_back(text_width(random), text_height(random));
+	}
+
+	auto columns = pack_glyphs<column_packer>(glyph_sizes, sheet_size, max_glyph_count);
+	auto skyline = pack_glyphs<skyline_packer>(glyph_sizes, sheet_size, max_glyph_count);
+
+	std::printf("\nglyph packing, %zu glyphs into %ux%u sheets\n", glyph_count, sheet_size, sheet_size);
+	std::printf("%8s %8s %10s %14s\n", "packer", "sheets", "occupancy", "us per insert");
+	std::printf("%8s %8zu %9.1f%% %14.2f\n", "columns", columns.sheet_count, columns.occupancy * 100.0, columns.insert_microseconds);
+	std::printf("%8s %8zu %9.1f%% %14.2f\n", "skyline", skyline.sheet_count, skyline.occupancy * 100.0, skyline.insert_microseconds);
+}
+
+void run_benchmarks()
+{
+	widget_list_recording_benchmark();
+	glyph_packing_benchmark();
+}
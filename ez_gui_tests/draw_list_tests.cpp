@@ -0,0 +1,97 @@
+#include "tests.h"
+#include "../dx11_renderer/renderer.h"
+
+//
+// draw_list tests
+//
+
+// record the same frame of shapes, clip rects and cached geometry, nothing here needs a device
+static void record_frame(renderer& renderer, geometry_cache& cache)
+{
+	renderer.add_rect_filled({ 10.f, 10.f }, { 200.f, 100.f }, colors::gray);
+	renderer.add_rect_filled_multicolor({ 10.f, 120.f }, { 200.f, 100.f }, colors::white, colors::black, colors::black, colors::white, true);
+	renderer.add_line({ 0.f, 0.f }, { 300.f, 300.f }, colors::black);
+	renderer.add_triangle_filled({ 300.f, 10.f }, { 350.f, 60.f }, { 250.f, 60.f }, colors::white);
+
+	renderer.push_clip_rect({ 400.f, 0.f }, { 200.f, 200.f });
+	renderer.add_circle({ 500.f, 100.f }, 80.f, colors::black);
+	renderer.add_circle_filled({ 500.f, 100.f }, 40.f, colors::gray);
+	renderer.add_arc({ 500.f, 100.f }, 60.f, 0.f, PI, colors::white);
+	renderer.pop_clip_rect();
+
+	// the first frame records what later frames add from the cache
+	if (!renderer.add_geometry(cache))
+	{
+		renderer.begin_geometry_capture();
+		for (auto i = 0; i < 64; ++i)
+			renderer.add_frame({ 10.f + i * 12.f, 400.f }, { 10.f, 10.f }, 1.f, colors::black);
+		renderer.end_geometry_capture(cache);
+	}
+}
+
+// once a frame was recorded, recording the same frame again reuses the draw list storage without growing it
+static void steady_state_frames_do_not_allocate()
+{
+	constexpr auto warmup_frames = 2;
+	constexpr auto frame_count = 32;
+
+	renderer renderer;
+	draw_list list;
+	geometry_cache cache;
+
+	renderer.set_thread_draw_list(&list);
+	list.set_viewport({ { 0.f, 0.f }, { 1920.f, 1080.f } });
+
+	draw_list_stats first_stats{};
+	for (auto frame = 0; frame < frame_count; ++frame)
+	{
+		list.clear();
+		record_frame(renderer, cache);
+		list.finish_primitive();
+
+		auto stats = list.get_stats();
+		if (frame == 0)
+		{
+			TEST_CHECK(stats.vertex_count > 0 && stats.index_count > 0);
+			first_stats = stats;
+		}
+
+		if (frame < warmup_frames)
+			continue;
+
+		TEST_CHECK(stats.allocation_count == 0);
+		TEST_CHECK(stats.vertex_count == first_stats.vertex_count);
+		TEST_CHECK(stats.index_count == first_stats.index_count);
+		TEST_CHECK(stats.batch_count == first_stats.batch_count);
+	}
+
+	renderer.set_thread_draw_list(nullptr);
+}
+
+// inserting glyphs rasterized in the background only drops the runs that were laid out with placeholders for them
+static void placeholder_runs_are_evicted_alone()
+{
+	text_layout_cache cache{ 1 << 20 };
+
+	std::wstring pending_text = L"pending";
+	std::wstring ready_text = L"ready";
+	text_layout_cache::key pending_key{ pending_text, 0, 0, { 100.f, 20.f }, { 0.f, 0.f } };
+	text_layout_cache::key ready_key{ ready_text, 0, 0, { 100.f, 20.f }, { 0.f, 0.f } };
+
+	cache.insert(pending_key, glyph_run{ std::vector<FW1_GLYPHVERTEX>(7), true });
+	cache.insert(ready_key, glyph_run{ std::vector<FW1_GLYPHVERTEX>(5), false });
+
+	auto memory_used = cache.get_stats().memory_used;
+	cache.evict_placeholder_runs();
+
+	TEST_CHECK(cache.find(pending_key) == nullptr);
+	TEST_CHECK(cache.find(ready_key) != nullptr);
+	TEST_CHECK(cache.get_stats().entry_count == 1);
+	TEST_CHECK(cache.get_stats().memory_used < memory_used);
+}
+
+void run_draw_list_tests()
+{
+	steady_state_frames_do_not_allocate();
+	placeholder_runs_are_evicted_alone();
+}
@@ -0,0 +1,303 @@
+#include <windows.h>
+#include <intrin.h>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <numeric>
+#include <algorithm>
+
+#include "tests.h"
+#include "../FW1FontWrapper/Source/CFW1HashTable.h"
+#include "../FW1FontWrapper/Source/CFW1GlyphPages.h"
+
+//
+// CFW1HashTable and CFW1GlyphPages tests
+//
+
+constexpr auto reader_count = 3;
+
+// the value a key or glyph is stored with, never the not found value
+static UINT stored_value(UINT key)
+{
+	return key ^ 0x5a5a0000;
+}
+
+// keys inserted on one thread are found by threads looking them up meanwhile, also while the table grows
+// colliding hashes make every probe walk one long cluster, which moves to a new table on every growth
+static void hash_table_insert_while_find(UINT key_count, bool colliding_hashes)
+{
+	FW1FontWrapper::CFW1HashTable<UINT, UINT> table;
+	auto hash_key = [colliding_hashes](UINT key) { return colliding_hashes ? key & 0x3f : FW1FontWrapper::hashBits(key); };
+
+	std::atomic<UINT> inserted = 0;
+	std::atomic<int> readers_started = 0;
+	std::atomic<bool> writer_done = false;
+	std::atomic<uint32_t> wrong_values = 0, lookups = 0;
+
+	std::vector<std::thread> readers;
+	for (auto i = 0; i < reader_count; ++i)
+	{
+		readers.emplace_back([&, i]()
+		{
+			std::mt19937 rng{ static_cast<uint32_t>(i + 1) };
+			readers_started++;
+
+			// keep looking up for one more round after the writer is done
+			auto last_round = false;
+			while (!last_round)
+			{
+				last_round = writer_done;
+				auto count = inserted.load();
+
+				for (auto j = 0; j < 64; ++j)
+				{
+					// a key that was inserted must be found with its value
+					if (count > 0)
+					{
+						auto key = rng() % count;
+						if (table.find(key, hash_key(key), 0xffffffff) != stored_value(key))
+							wrong_values++;
+					}
+
+					// a key that may be inserted right now is either missing or has its value
+					auto key = rng() % key_count;
+					auto value = table.find(key, hash_key(key), 0xffffffff);
+					if (value != 0xffffffff && value != stored_value(key))
+						wrong_values++;
+
+					// a key that is never inserted is never found
+					key = key_count + rng() % key_count;
+					if (table.find(key, hash_key(key), 0xffffffff) != 0xffffffff)
+						wrong_values++;
+				}
+
+				lookups += 64;
+			}
+		});
+	}
+
+	while (readers_started < reader_count)
+		std::this_thread::yield();
+
+	for (UINT key = 0; key < key_count; ++key)
+	{
+		table.insert(key, hash_key(key), stored_value(key));
+		inserted = key + 1;
+
+		// let the readers in between inserts, even with a single core
+		if (key % 64 == 0)
+			std::this_thread::yield();
+	}
+
+	writer_done = true;
+	for (auto& reader : readers)
+		reader.join();
+
+	TEST_CHECK(wrong_values == 0);
+	TEST_CHECK(lookups > 0);
+	TEST_CHECK(table.getCount() == key_count);
+
+	auto missing = 0u;
+	for (UINT key = 0; key < key_count; ++key)
+	{
+		if (table.find(key, hash_key(key), 0xffffffff) != stored_value(key))
+			missing++;
+	}
+	TEST_CHECK(missing == 0);
+}
+
+// glyphs set in random order on one thread are read by threads meanwhile, while their pages get allocated
+static void glyph_pages_set_while_get()
+{
+	constexpr UINT glyph_count = 65536;
+
+	FW1FontWrapper::CFW1GlyphPages pages{ glyph_count };
+
+	std::vector<UINT> order(glyph_count);
+	std::iota(order.begin(), order.end(), 0u);
+	std::shuffle(order.begin(), order.end(), std::mt19937{ 7 });
+
+	std::atomic<UINT> set_count = 0;
+	std::atomic<int> readers_started = 0;
+	std::atomic<bool> writer_done = false;
+	std::atomic<uint32_t> wrong_values = 0, lookups = 0;
+
+	std::vector<std::thread> readers;
+	for (auto i = 0; i < reader_count; ++i)
+	{
+		readers.emplace_back([&, i]()
+		{
+			std::mt19937 rng{ static_cast<uint32_t>(i + 1) };
+			readers_started++;
+
+			auto last_round = false;
+			while (!last_round)
+			{
+				last_round = writer_done;
+				auto count = set_count.load();
+
+				for (auto j = 0; j < 64; ++j)
+				{
+					// a glyph that was set must have its id, even when its page was only just published
+					if (count > 0)
+					{
+						auto glyph = order[rng() % count];
+						if (pages.getAtlasId(glyph) != stored_value(glyph))
+							wrong_values++;
+					}
+
+					// any other glyph is either not set yet or has its id
+					auto glyph = rng() % glyph_count;
+					auto id = pages.getAtlasId(glyph);
+					if (id != 0xffffffff && id != stored_value(glyph))
+						wrong_values++;
+				}
+
+				lookups += 64;
+			}
+		});
+	}
+
+	while (readers_started < reader_count)
+		std::this_thread::yield();
+
+	for (UINT i = 0; i < glyph_count; ++i)
+	{
+		pages.setAtlasId(order[i], stored_value(order[i]));
+		set_count = i + 1;
+
+		if (i % 64 == 0)
+			std::this_thread::yield();
+	}
+
+	writer_done = true;
+	for (auto& reader : readers)
+		reader.join();
+
+	TEST_CHECK(wrong_values == 0);
+	TEST_CHECK(lookups > 0);
+	TEST_CHECK(pages.getPageCount() == glyph_count / FW1FontWrapper::CFW1GlyphPages::PageSize);
+
+	auto missing = 0u;
+	for (UINT glyph = 0; glyph < glyph_count; ++glyph)
+	{
+		if (pages.getAtlasId(glyph) != stored_value(glyph))
+			missing++;
+	}
+	TEST_CHECK(missing == 0);
+}
+
+// glyphs marked pending and then given their id later, like queued glyphs that worker threads rasterize
+// once a glyph is marked pending, readers see it pending or with its id, never unset again
+static void glyph_pages_pending_then_set()
+{
+	constexpr UINT glyph_count = 16384;
+	constexpr UINT pending_id = 0xfffffffe;
+	constexpr UINT batch_size = 512;
+
+	FW1FontWrapper::CFW1GlyphPages pages{ glyph_count };
+
+	std::vector<UINT> order(glyph_count);
+	std::iota(order.begin(), order.end(), 0u);
+	std::shuffle(order.begin(), order.end(), std::mt19937{ 11 });
+
+	std::atomic<UINT> pending_count = 0, set_count = 0;
+	std::atomic<int> readers_started = 0;
+	std::atomic<bool> writer_done = false;
+	std::atomic<uint32_t> wrong_values = 0, lookups = 0;
+
+	std::vector<std::thread> readers;
+	for (auto i = 0; i < reader_count; ++i)
+	{
+		readers.emplace_back([&, i]()
+		{
+			std::mt19937 rng{ static_cast<uint32_t>(i + 1) };
+			readers_started++;
+
+			auto last_round = false;
+			while (!last_round)
+			{
+				last_round = writer_done;
+				auto set = set_count.load();
+				auto pending = pending_count.load();
+
+				for (auto j = 0; j < 64; ++j)
+				{
+					if (set > 0)
+					{
+						auto glyph = order[rng() % set];
+						if (pages.getAtlasId(glyph) != stored_value(glyph))
+							wrong_values++;
+					}
+
+					if (pending > set)
+					{
+						auto glyph = order[set + rng() % (pending - set)];
+						auto id = pages.getAtlasId(glyph);
+						if (id != pending_id && id != stored_value(glyph))
+							wrong_values++;
+					}
+				}
+
+				lookups += 64;
+			}
+		});
+	}
+
+	while (readers_started < reader_count)
+		std::this_thread::yield();
+
+	// mark a batch pending, then give the batch its ids, the way completed glyphs are inserted once per frame
+	for (UINT batch = 0; batch < glyph_count; batch += batch_size)
+	{
+		for (UINT i = batch; i < batch + batch_size; ++i)
+		{
+			pages.setAtlasId(order[i], pending_id);
+			pending_count = i + 1;
+		}
+		std::this_thread::yield();
+
+		for (UINT i = batch; i < batch + batch_size; ++i)
+		{
+			pages.setAtlasId(order[i], stored_value(order[i]));
+			set_count = i + 1;
+
+			if (i % 64 == 0)
+				std::this_thread::yield();
+		}
+	}
+
+	writer_done = true;
+	for (auto& reader : readers)
+		reader.join();
+
+	TEST_CHECK(wrong_values == 0);
+	TEST_CHECK(lookups > 0);
+}
+
+// clearing an id never allocates its page, and glyph 0 always has a page slot
+static void glyph_pages_empty()
+{
+	FW1FontWrapper::CFW1GlyphPages empty_font{ 0 };
+	TEST_CHECK(empty_font.getPageCount() == 1);
+	TEST_CHECK(empty_font.getAtlasId(0) == 0xffffffff);
+
+	FW1FontWrapper::CFW1GlyphPages pages{ 1000 };
+	pages.setAtlasId(700, 0xffffffff);
+	TEST_CHECK(pages.getPage(700 / FW1FontWrapper::CFW1GlyphPages::PageSize) == nullptr);
+
+	pages.setAtlasId(700, 5);
+	TEST_CHECK(pages.getAtlasId(700) == 5);
+	TEST_CHECK(pages.getAtlasId(701) == 0xffffffff);
+	TEST_CHECK(pages.getPage(0) == nullptr);
+}
+
+void run_glyph_cache_tests()
+{
+	hash_table_insert_while_find(100000, false);
+	hash_table_insert_while_find(2000, true);
+	glyph_pages_set_while_get();
+	glyph_pages_pending_then_set();
+	glyph_pages_empty();
+}
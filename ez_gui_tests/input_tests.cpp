@@ -0,0 +1,241 @@
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+#include "tests.h"
+#include "../ez_gui/widget_utils.h"
+
+//
+// spsc_ring and input_channel tests
+//
+
+// values pushed on one thread come out on the other in the order they were pushed, with nothing lost or repeated
+static void ring_order_stress()
+{
+	constexpr uint64_t value_count = 1000000;
+
+	spsc_ring<uint64_t, 64> ring;
+	std::thread producer{ [&ring]()
+	{
+		for (uint64_t value = 0; value < value_count; ++value)
+		{
+			while (!ring.push(value))
+				std::this_thread::yield();
+		}
+	} };
+
+	uint64_t expected = 0, out_of_order = 0, value = 0;
+	while (expected < value_count)
+	{
+		if (!ring.pop(value))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		if (value != expected)
+			out_of_order++;
+
+		expected = value + 1;
+	}
+
+	producer.join();
+
+	TEST_CHECK(out_of_order == 0);
+	TEST_CHECK(ring.size() == 0);
+}
+
+// receive every message that is ready, flushing the backlog in between like the message loop does
+static std::vector<widget_input> drain_channel(input_channel& channel)
+{
+	std::vector<widget_input> received;
+	widget_input msg{ vec2{} };
+
+	do
+	{
+		while (channel.pop(msg))
+			received.push_back(msg);
+
+		channel.flush();
+	} while (channel.size() > 0);
+
+	return received;
+}
+
+// messages that do not fit into the ring wait in the backlog in order, mouse moves behind each other get merged
+static void channel_backlog_order()
+{
+	input_channel channel;
+
+	for (auto i = 0; i < INPUT_RING_CAPACITY; ++i)
+		channel.push(widget_input{ vec2{ static_cast<float>(i), 0.f } });
+
+	channel.push(widget_input{ input_type::lbutton_down, vec2{ 1000.f, 0.f } });
+	for (auto i = 0; i < 10; ++i)
+		channel.push(widget_input{ vec2{ 2000.f + i, 0.f } });
+	channel.push(widget_input{ input_type::lbutton_up, vec2{ 3000.f, 0.f } });
+	channel.push(widget_input{ 'a' });
+
+	TEST_CHECK(channel.size() == INPUT_RING_CAPACITY);
+
+	auto received = drain_channel(channel);
+
+	TEST_CHECK(received.size() == INPUT_RING_CAPACITY + 4);
+	if (received.size() != INPUT_RING_CAPACITY + 4)
+		return;
+
+	for (auto i = 0; i < INPUT_RING_CAPACITY; ++i)
+		TEST_CHECK(received[i].type == input_type::mouse_move && received[i].m_pos.x == static_cast<float>(i));
+
+	auto backlog = received.data() + INPUT_RING_CAPACITY;
+	TEST_CHECK(backlog[0].type == input_type::lbutton_down && backlog[0].m_pos.x == 1000.f);
+	TEST_CHECK(backlog[1].type == input_type::mouse_move && backlog[1].m_pos.x == 2009.f);
+	TEST_CHECK(backlog[2].type == input_type::lbutton_up && backlog[2].m_pos.x == 3000.f);
+	TEST_CHECK(backlog[3].type == input_type::key_press && backlog[3].key == 'a');
+
+	TEST_CHECK(channel.take_coalesced_count() == 9);
+	TEST_CHECK(channel.take_dropped_count() == 0);
+}
+
+// a full backlog makes room by dropping its oldest mouse move, key presses are only lost once nothing else is left to drop
+static void channel_backlog_full()
+{
+	input_channel channel;
+
+	for (auto i = 0; i < INPUT_RING_CAPACITY; ++i)
+		channel.push(widget_input{ vec2{ 0.f, 0.f } });
+
+	// key presses with mouse moves in between, so the moves can not be merged
+	char key = 0;
+	for (auto i = 0; i < INPUT_BACKLOG_CAPACITY / 2; ++i)
+	{
+		channel.push(widget_input{ key++ });
+		channel.push(widget_input{ vec2{ static_cast<float>(i), 0.f } });
+	}
+
+	// every key press now takes the place of a mouse move until none are left
+	for (auto i = 0; i < INPUT_BACKLOG_CAPACITY / 2; ++i)
+		channel.push(widget_input{ key++ });
+
+	TEST_CHECK(channel.take_coalesced_count() == INPUT_BACKLOG_CAPACITY / 2);
+	TEST_CHECK(channel.take_dropped_count() == 0);
+
+	// the backlog is nothing but key presses, so this one is lost
+	channel.push(widget_input{ key });
+	TEST_CHECK(channel.take_dropped_count() == 1);
+
+	auto received = drain_channel(channel);
+	TEST_CHECK(received.size() == INPUT_RING_CAPACITY + INPUT_BACKLOG_CAPACITY);
+	if (received.size() != INPUT_RING_CAPACITY + INPUT_BACKLOG_CAPACITY)
+		return;
+
+	for (auto i = 0; i < INPUT_BACKLOG_CAPACITY; ++i)
+	{
+		auto& msg = received[INPUT_RING_CAPACITY + i];
+		TEST_CHECK(msg.type == input_type::key_press && msg.key == static_cast<char>(i));
+	}
+}
+
+// a producer that sends far more mouse moves than the consumer drains, clicks and key presses still all arrive in order
+static void channel_overflow_stress()
+{
+	constexpr uint32_t round_count = 500;
+	constexpr uint32_t moves_per_round = 100;
+	constexpr uint32_t rounds_before_consumer = 10;
+
+	input_channel channel;
+	std::atomic<bool> consumer_started = false, consumer_done = false;
+
+	// the producer plays the window procedure plus the message loop, which flushes once per loop
+	std::thread producer{ [&]()
+	{
+		uint32_t move_seq = 0, click_seq = 0;
+		char key_seq = 0;
+
+		for (auto round = 0u; round < round_count; ++round)
+		{
+			for (auto i = 0u; i < moves_per_round; ++i)
+				channel.push(widget_input{ vec2{ static_cast<float>(move_seq++), 0.f } });
+
+			channel.push(widget_input{ input_type::lbutton_down, vec2{ static_cast<float>(click_seq++), 0.f } });
+			channel.push(widget_input{ input_type::lbutton_up, vec2{ static_cast<float>(click_seq++), 0.f } });
+			channel.push(widget_input{ static_cast<char>(key_seq++ & 0x7f) });
+
+			channel.flush();
+
+			// the consumer starts late, so the ring has overflowed before anything is received
+			if (round + 1 == rounds_before_consumer)
+				consumer_started = true;
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		// keep pumping until everything left in the backlog got through
+		while (!consumer_done)
+		{
+			channel.flush();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	} };
+
+	while (!consumer_started)
+		std::this_thread::yield();
+
+	uint32_t clicks = 0, keys = 0, out_of_order = 0;
+	float last_move = -1.f;
+	size_t coalesced_count = 0, dropped_count = 0;
+	auto give_up = input_clock::now() + std::chrono::seconds(30);
+
+	widget_input msg{ vec2{} };
+	while (clicks + keys < round_count * 3 && input_clock::now() < give_up)
+	{
+		while (channel.pop(msg))
+		{
+			switch (msg.type)
+			{
+			case input_type::mouse_move:
+				if (msg.m_pos.x <= last_move)
+					out_of_order++;
+				last_move = msg.m_pos.x;
+				break;
+			case input_type::lbutton_down:
+			case input_type::lbutton_up:
+				if (msg.type != (clicks % 2 == 0 ? input_type::lbutton_down : input_type::lbutton_up) || msg.m_pos.x != static_cast<float>(clicks))
+					out_of_order++;
+				clicks++;
+				break;
+			case input_type::key_press:
+				if (msg.key != static_cast<char>(keys & 0x7f))
+					out_of_order++;
+				keys++;
+				break;
+			}
+		}
+
+		coalesced_count += channel.take_coalesced_count();
+		dropped_count += channel.take_dropped_count();
+
+		// a consumer that is slower than the producer, like a frame that takes a while
+		std::this_thread::sleep_for(std::chrono::milliseconds(4));
+	}
+
+	consumer_done = true;
+	producer.join();
+
+	TEST_CHECK(out_of_order == 0);
+	TEST_CHECK(clicks == round_count * 2);
+	TEST_CHECK(keys == round_count);
+	TEST_CHECK(dropped_count == 0);
+	TEST_CHECK(last_move == static_cast<float>(round_count * moves_per_round - 1));
+
+	// the test only means something if the ring actually overflowed
+	TEST_CHECK(coalesced_count > 0);
+}
+
+void run_input_tests()
+{
+	ring_order_stress();
+	channel_backlog_order();
+	channel_backlog_full();
+	channel_overflow_stress();
+}
@@ -0,0 +1,25 @@
+#include <cstring>
+
+#include "tests.h"
+
+int main(int argc, char** argv)
+{
+	if (argc > 1 && std::strcmp(argv[1], "bench") == 0)
+	{
+		run_benchmarks();
+		return 0;
+	}
+
+	run_input_tests();
+	run_draw_list_tests();
+	run_glyph_cache_tests();
+
+	if (test_failures > 0)
+	{
+		std::printf("%d checks failed\n", test_failures);
+		return 1;
+	}
+
+	std::printf("all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdio>
+
+//
+// test utilities
+//
+
+// amount of checks that failed, main returns it
+inline int test_failures = 0;
+
+// check a condition, a failed check prints where it failed and is counted, the test keeps going
+// only call it from the thread that runs the test
+#define TEST_CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			std::printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition); \
+			test_failures++; \
+		} \
+	} while (0)
+
+// spsc_ring and input_channel tests
+void run_input_tests();
+
+// draw_list tests
+void run_draw_list_tests();
+
+// lock-free glyph cache tables of FW1FontWrapper tests
+void run_glyph_cache_tests();
+
+// print timings of the things the tests can not check, run with "bench" as the first argument
+void run_benchmarks();